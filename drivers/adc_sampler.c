@@ -0,0 +1,157 @@
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/logging/log.h>
+#include "config.h"
+#include "adc_sampler.h"
+#include "sensor_filter.h"
+
+LOG_MODULE_REGISTER(adc_sampler, LOG_LEVEL_INF);
+
+// Two-point linear calibration from pin millivolts to the reported unit
+struct adc_input_cfg {
+    uint8_t channel_id;
+    int32_t mv_lo;
+    int32_t mv_hi;
+    int32_t out_lo;
+    int32_t out_hi;
+    bool clamp;
+};
+
+static const struct adc_input_cfg inputs_cfg[ADC_INPUT_COUNT] = {
+    [ADC_INPUT_LIGHT] = {
+        .channel_id = ADC_CHANNEL_LIGHT,
+        .mv_lo = LIGHT_ADC_DARK_MV, .mv_hi = LIGHT_ADC_BRIGHT_MV,
+        .out_lo = 0, .out_hi = 10000,
+        .clamp = true,
+    },
+    [ADC_INPUT_SOIL] = {
+        .channel_id = ADC_CHANNEL_SOIL,
+        .mv_lo = SOIL_ADC_DRY_MV, .mv_hi = SOIL_ADC_WET_MV,
+        .out_lo = 0, .out_hi = 10000,
+        .clamp = true,
+    },
+    [ADC_INPUT_BATTERY] = {
+        .channel_id = ADC_CHANNEL_BATTERY,
+        .mv_lo = 0, .mv_hi = 1000,
+        .out_lo = 0, .out_hi = 1000 * BATTERY_DIVIDER_RATIO,
+        .clamp = false,
+    },
+};
+
+static const struct device *adc;
+static struct adc_sampler_stats stats;
+
+int adc_sampler_init(const struct device *adc_dev)
+{
+    int ret;
+
+    adc = adc_dev;
+
+    for (int i = 0; i < ADC_INPUT_COUNT; i++) {
+        struct adc_channel_cfg channel_cfg = {
+            .gain = ADC_GAIN,
+            .reference = ADC_REFERENCE,
+            .acquisition_time = ADC_ACQUISITION_TIME,
+            .channel_id = inputs_cfg[i].channel_id,
+            .differential = false
+        };
+
+        ret = adc_channel_setup(adc, &channel_cfg);
+        if (ret) {
+            LOG_ERR("Failed to setup ADC channel %u: %d", channel_cfg.channel_id, ret);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+static int32_t calibrate(const struct adc_input_cfg *cfg, int32_t mv)
+{
+    int32_t out = cfg->out_lo +
+                  (mv - cfg->mv_lo) * (cfg->out_hi - cfg->out_lo) / (cfg->mv_hi - cfg->mv_lo);
+
+    if (cfg->clamp) {
+        out = CLAMP(out, MIN(cfg->out_lo, cfg->out_hi), MAX(cfg->out_lo, cfg->out_hi));
+    }
+
+    return out;
+}
+
+// One adc_read() per conversion: the ESP32 driver rejects multi-channel
+// sequences and extra_samplings, so the burst is taken in software
+static int read_input(int i, struct adc_sampler_result *result)
+{
+    int16_t sample;
+    const struct adc_sequence seq = {
+        .channels = BIT(inputs_cfg[i].channel_id),
+        .buffer = &sample,
+        .buffer_size = sizeof(sample),
+        .resolution = ADC_RESOLUTION,
+        .oversampling = ADC_OVERSAMPLING,
+        .calibrate = false
+    };
+    int32_t burst[ADC_BURST_SAMPLES];
+    int32_t mv;
+    int ret;
+
+    // Repeat the conversion so a single glitched sample is outvoted
+    for (int k = 0; k < ADC_BURST_SAMPLES; k++) {
+        ret = adc_read(adc, &seq);
+        if (ret) {
+            LOG_ERR("ADC channel %u failed: %d", inputs_cfg[i].channel_id, ret);
+            return ret;
+        }
+        burst[k] = sample;
+    }
+    mv = sensor_filter_median(burst, ADC_BURST_SAMPLES);
+
+    result->raw[i] = mv;
+    adc_raw_to_millivolts(adc_ref_internal(adc), ADC_GAIN, ADC_RESOLUTION, &mv);
+    result->millivolts[i] = mv;
+    result->value[i] = calibrate(&inputs_cfg[i], mv);
+    result->valid |= BIT(i);
+
+    return 0;
+}
+
+int adc_sampler_read(uint32_t inputs, struct adc_sampler_result *result)
+{
+    uint32_t start;
+    uint32_t elapsed_us;
+    int ret = 0;
+    int err;
+
+    result->valid = 0;
+
+    if ((inputs & BIT_MASK(ADC_INPUT_COUNT)) == 0) {
+        return 0;
+    }
+
+    start = k_cycle_get_32();
+    for (int i = 0; i < ADC_INPUT_COUNT; i++) {
+        if (inputs & BIT(i)) {
+            // A failed channel does not cost the others their reading
+            err = read_input(i, result);
+            if (err && ret == 0) {
+                ret = err;
+            }
+        }
+    }
+    elapsed_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+    stats.bursts++;
+    stats.last_us = elapsed_us;
+    stats.total_us += elapsed_us;
+    stats.max_us = MAX(stats.max_us, elapsed_us);
+    if (ret) {
+        stats.errors++;
+    }
+
+    return ret;
+}
+
+const struct adc_sampler_stats *adc_sampler_get_stats(void)
+{
+    return &stats;
+}
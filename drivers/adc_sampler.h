@@ -0,0 +1,57 @@
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <zephyr/device.h>
+
+// Analog inputs covered by the shared conversion sequence
+enum adc_input {
+    ADC_INPUT_LIGHT,          // Photoresistor divider, centi-percent
+    ADC_INPUT_SOIL,           // Analog capacitive soil probe, centi-percent
+    ADC_INPUT_BATTERY,        // Battery divider, millivolts at the cell
+    ADC_INPUT_COUNT
+};
+
+struct adc_sampler_result {
+    uint32_t valid;           // BIT(enum adc_input) for each converted input
+    int16_t raw[ADC_INPUT_COUNT];   // Burst median
+    int32_t millivolts[ADC_INPUT_COUNT];
+    int32_t value[ADC_INPUT_COUNT];  // Calibrated value, see enum adc_input
+};
+
+struct adc_sampler_stats {
+    uint32_t bursts;
+    uint32_t errors;
+    uint32_t last_us;
+    uint32_t max_us;
+    uint64_t total_us;
+};
+
+/**
+ * @brief Set up every ADC channel used by the sampler
+ *
+ * @param adc_dev Pointer to ADC device structure
+ * @return 0 on success, negative errno on failure
+ */
+int adc_sampler_init(const struct device *adc_dev);
+
+/**
+ * @brief Convert several inputs back to back
+ *
+ * Each input is converted ADC_BURST_SAMPLES times and reports the median of
+ * its burst. Inputs that converted are flagged in result->valid even when
+ * another one failed.
+ *
+ * @param inputs BIT(enum adc_input) for each input to convert
+ * @param result Pointer to store raw, millivolt and calibrated values
+ * @return 0 on success, first negative errno if any input failed
+ */
+int adc_sampler_read(uint32_t inputs, struct adc_sampler_result *result);
+
+/**
+ * @brief Get conversion timing counters
+ *
+ * @return Pointer to the sampler counters
+ */
+const struct adc_sampler_stats *adc_sampler_get_stats(void);
+
+#endif /* ADC_SAMPLER_H */
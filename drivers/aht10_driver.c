@@ -2,6 +2,7 @@
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/logging/log.h>
 #include "config.h"
+#include "i2c_trace.h"
 
 LOG_MODULE_REGISTER(aht10_driver, LOG_LEVEL_INF);
 
@@ -9,20 +10,39 @@ LOG_MODULE_REGISTER(aht10_driver, LOG_LEVEL_INF);
 #define AHT10_CMD_INIT 0xBE
 #define AHT10_CMD_MEASURE 0xAC
 
-int aht10_read(struct device *i2c_dev, float *temperature, float *humidity)
+int aht10_init(const struct device *i2c_dev)
+{
+    uint8_t cmd_init[] = {AHT10_CMD_INIT, 0x08, 0x00};
+    struct i2c_msg msg = {
+        .buf = cmd_init,
+        .len = sizeof(cmd_init),
+        .flags = I2C_MSG_WRITE | I2C_MSG_STOP,
+    };
+    int ret;
+
+    ret = i2c_trace_transfer(i2c_dev, &msg, 1, AHT10_ADDR);
+    if (ret != 0) {
+        LOG_ERR("AHT10 init failed: %d", ret);
+    }
+
+    return ret;
+}
+
+int aht10_read(const struct device *i2c_dev, float *temperature, float *humidity)
 {
     uint8_t cmd_measure[] = {AHT10_CMD_MEASURE, 0x00};
     uint8_t data[6];
     int ret;
 
-    ret = i2c_write_read(i2c_dev, AHT10_ADDR << 1, cmd_measure, sizeof(cmd_measure), data, sizeof(data));
+    ret = i2c_trace_write_read(i2c_dev, AHT10_ADDR, cmd_measure, sizeof(cmd_measure), data, sizeof(data));
     if (ret != 0) {
         LOG_ERR("AHT10 read failed: %d", ret);
         return ret;
     }
 
-    uint32_t raw_temp = (data[3] << 16) | (data[4] << 8) | data[5];
-    uint32_t raw_humidity = (data[1] << 16) | (data[2] << 8) | data[3];
+    // 20-bit humidity then 20-bit temperature, sharing the nibbles of byte 3
+    uint32_t raw_humidity = (data[1] << 12) | (data[2] << 4) | (data[3] >> 4);
+    uint32_t raw_temp = ((data[3] & 0x0F) << 16) | (data[4] << 8) | data[5];
 
     *temperature = (raw_temp / 1048576.0f) * 200.0f - 50.0f;
     *humidity = (raw_humidity / 1048576.0f) * 100.0f;
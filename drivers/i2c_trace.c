@@ -0,0 +1,158 @@
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/logging/log.h>
+#include "config.h"
+#include "i2c_trace.h"
+
+LOG_MODULE_REGISTER(i2c_trace, LOG_LEVEL_INF);
+
+#if I2C_TRACE_ENABLED
+
+static struct i2c_trace_stats trace[I2C_TRACE_MAX_ADDRS];
+static int trace_count;
+static struct k_spinlock trace_lock;
+
+// Bus clocks for a transfer: START + address byte + 9 clocks per data byte
+// for every message, plus the final STOP.
+static uint32_t wire_bits(const struct i2c_msg *msgs, uint8_t num_msgs)
+{
+    uint32_t bits = 1;
+
+    for (uint8_t i = 0; i < num_msgs; i++) {
+        bits += 1 + 9 + 9 * msgs[i].len;
+    }
+
+    return bits;
+}
+
+static struct i2c_trace_stats *trace_entry(uint16_t addr)
+{
+    for (int i = 0; i < trace_count; i++) {
+        if (trace[i].addr == addr) {
+            return &trace[i];
+        }
+    }
+
+    if (trace_count == ARRAY_SIZE(trace)) {
+        return NULL;
+    }
+
+    trace[trace_count].addr = addr;
+    return &trace[trace_count++];
+}
+
+int i2c_trace_transfer(const struct device *dev, struct i2c_msg *msgs,
+                       uint8_t num_msgs, uint16_t addr)
+{
+    struct i2c_trace_stats *entry;
+    k_spinlock_key_t key;
+    uint32_t start;
+    uint32_t elapsed_us;
+    int ret;
+
+    // Catches drivers passing the 8-bit (shifted) form of the address, which
+    // would target another device and split the accounting
+    if (addr > 0x7F && !(msgs[0].flags & I2C_MSG_ADDR_10_BITS)) {
+        LOG_ERR("Address 0x%x is not a 7-bit address", addr);
+        return -EINVAL;
+    }
+
+    start = k_cycle_get_32();
+    ret = i2c_transfer(dev, msgs, num_msgs, addr);
+    elapsed_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+    key = k_spin_lock(&trace_lock);
+    entry = trace_entry(addr);
+    if (entry) {
+        entry->transactions++;
+        entry->total_us += elapsed_us;
+        entry->max_us = MAX(entry->max_us, elapsed_us);
+        entry->wire_bits += wire_bits(msgs, num_msgs);
+        if (ret) {
+            entry->errors++;
+        }
+        for (uint8_t i = 0; i < num_msgs; i++) {
+            if ((msgs[i].flags & I2C_MSG_RW_MASK) == I2C_MSG_READ) {
+                entry->bytes_read += msgs[i].len;
+            } else {
+                entry->bytes_written += msgs[i].len;
+            }
+        }
+    }
+    k_spin_unlock(&trace_lock, key);
+
+    return ret;
+}
+
+int i2c_trace_count(void)
+{
+    return trace_count;
+}
+
+int i2c_trace_get(int idx, struct i2c_trace_stats *stats)
+{
+    k_spinlock_key_t key;
+
+    if (idx < 0 || idx >= trace_count) {
+        return -EINVAL;
+    }
+
+    key = k_spin_lock(&trace_lock);
+    *stats = trace[idx];
+    k_spin_unlock(&trace_lock, key);
+
+    return 0;
+}
+
+void i2c_trace_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&trace_lock);
+
+    memset(trace, 0, sizeof(trace));
+    trace_count = 0;
+    k_spin_unlock(&trace_lock, key);
+}
+
+#if defined(CONFIG_SHELL)
+void i2c_trace_print(const struct shell *sh)
+{
+    struct i2c_trace_stats stats;
+
+    shell_print(sh, "addr  xfers  errs  wr_B  rd_B  busy_us  max_us  wire_us@100k  wire_us@400k");
+    for (int i = 0; i < i2c_trace_count(); i++) {
+        if (i2c_trace_get(i, &stats)) {
+            continue;
+        }
+        shell_print(sh, "0x%02x  %5u  %4u  %4u  %4u  %7llu  %6u  %12u  %12u",
+                    stats.addr, stats.transactions, stats.errors,
+                    stats.bytes_written, stats.bytes_read, stats.total_us,
+                    stats.max_us, stats.wire_bits * 10, stats.wire_bits * 10 / 4);
+    }
+}
+
+static int cmd_i2c_trace_show(const struct shell *sh, size_t argc, char **argv)
+{
+    i2c_trace_print(sh);
+
+    return 0;
+}
+
+static int cmd_i2c_trace_reset(const struct shell *sh, size_t argc, char **argv)
+{
+    i2c_trace_reset();
+    shell_print(sh, "I2C trace counters cleared");
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(i2c_trace_cmds,
+    SHELL_CMD(show, NULL, "Show per-address I2C counters", cmd_i2c_trace_show),
+    SHELL_CMD(reset, NULL, "Clear I2C counters", cmd_i2c_trace_reset),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(i2c_trace, &i2c_trace_cmds, "I2C transaction tracer", NULL);
+#endif /* CONFIG_SHELL */
+
+#endif /* I2C_TRACE_ENABLED */
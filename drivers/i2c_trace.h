@@ -0,0 +1,131 @@
+#ifndef I2C_TRACE_H
+#define I2C_TRACE_H
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/i2c.h>
+#include "config.h"
+
+struct shell;
+
+// Per-address transaction accounting
+struct i2c_trace_stats {
+    uint16_t addr;
+    uint32_t transactions;
+    uint32_t errors;
+    uint32_t bytes_written;
+    uint32_t bytes_read;
+    uint32_t wire_bits;       // SCL clocks incl. address bytes, ACKs, START/STOP
+    uint64_t total_us;
+    uint32_t max_us;
+};
+
+#if I2C_TRACE_ENABLED
+
+/**
+ * @brief Perform an I2C transfer and account for it in the trace counters
+ *
+ * Drop-in replacement for i2c_transfer().
+ *
+ * @param dev Pointer to I2C device structure
+ * @param msgs Array of messages to transfer
+ * @param num_msgs Number of messages
+ * @param addr Target 7-bit address, as for i2c_transfer()
+ * @return 0 on success, -EINVAL for a shifted 8-bit address, negative errno on failure
+ */
+int i2c_trace_transfer(const struct device *dev, struct i2c_msg *msgs,
+                       uint8_t num_msgs, uint16_t addr);
+
+/**
+ * @brief Get the number of addresses seen by the tracer
+ *
+ * @return Number of valid entries for i2c_trace_get()
+ */
+int i2c_trace_count(void);
+
+/**
+ * @brief Copy the counters of one traced address
+ *
+ * @param idx Entry index, 0 to i2c_trace_count() - 1
+ * @param stats Pointer to store the counters
+ * @return 0 on success, -EINVAL if idx is out of range
+ */
+int i2c_trace_get(int idx, struct i2c_trace_stats *stats);
+
+/**
+ * @brief Clear all trace counters
+ */
+void i2c_trace_reset(void);
+
+/**
+ * @brief Print the per-address counters on a shell
+ *
+ * @param sh Shell to print on
+ */
+void i2c_trace_print(const struct shell *sh);
+
+#else
+
+static inline int i2c_trace_transfer(const struct device *dev, struct i2c_msg *msgs,
+                                     uint8_t num_msgs, uint16_t addr)
+{
+    return i2c_transfer(dev, msgs, num_msgs, addr);
+}
+
+static inline int i2c_trace_count(void)
+{
+    return 0;
+}
+
+static inline int i2c_trace_get(int idx, struct i2c_trace_stats *stats)
+{
+    return -EINVAL;
+}
+
+static inline void i2c_trace_reset(void)
+{
+}
+
+static inline void i2c_trace_print(const struct shell *sh)
+{
+}
+
+#endif /* I2C_TRACE_ENABLED */
+
+/**
+ * @brief Traced equivalent of i2c_write_read()
+ *
+ * @param dev Pointer to I2C device structure
+ * @param addr Target address
+ * @param write_buf Bytes to write (may be NULL if num_write is 0)
+ * @param num_write Number of bytes to write
+ * @param read_buf Buffer for the bytes read
+ * @param num_read Number of bytes to read
+ * @return 0 on success, negative errno on failure
+ */
+static inline int i2c_trace_write_read(const struct device *dev, uint16_t addr,
+                                       const void *write_buf, size_t num_write,
+                                       void *read_buf, size_t num_read)
+{
+    struct i2c_msg msg[2];
+    uint8_t num_msgs = 0;
+
+    if (num_write > 0) {
+        msg[num_msgs].buf = (uint8_t *)write_buf;
+        msg[num_msgs].len = num_write;
+        msg[num_msgs].flags = I2C_MSG_WRITE;
+        num_msgs++;
+    }
+
+    // Repeated START only after a write; a lone read starts the transfer
+    msg[num_msgs].buf = (uint8_t *)read_buf;
+    msg[num_msgs].len = num_read;
+    msg[num_msgs].flags = I2C_MSG_READ | I2C_MSG_STOP;
+    if (num_msgs > 0) {
+        msg[num_msgs].flags |= I2C_MSG_RESTART;
+    }
+    num_msgs++;
+
+    return i2c_trace_transfer(dev, msg, num_msgs, addr);
+}
+
+#endif /* I2C_TRACE_H */
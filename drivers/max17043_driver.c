@@ -1,30 +1,172 @@
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/i2c.h>
+#include <zephyr/sys/byteorder.h>
 #include <zephyr/logging/log.h>
 #include "config.h"
+#include "i2c_trace.h"
+#include "max17043_driver.h"
 
 LOG_MODULE_REGISTER(max17043_driver, LOG_LEVEL_INF);
 
 #define MAX17043_ADDR 0x36
-#define MAX17043_REG_SOC 0x04
 
-int max17043_read(struct device *i2c_dev, float *battery_level)
+// One auto-incrementing read covers VCELL through CONFIG
+#define MAX17043_BURST_FIRST  MAX17043_REG_VCELL
+#define MAX17043_BURST_LEN    (MAX17043_REG_CONFIG + 2 - MAX17043_BURST_FIRST)
+#define BURST_OFFSET(reg)     ((reg) - MAX17043_BURST_FIRST)
+
+// CONFIG register, low byte
+#define MAX17043_CONFIG_ALRT  BIT(5)
+#define MAX17043_CONFIG_ATHD  0x1F
+
+static struct {
+    uint8_t regs[MAX17043_BURST_LEN];
+    int64_t read_ms;
+    bool valid;
+} snapshot;
+
+static int burst_read(const struct device *i2c_dev)
 {
-    uint8_t reg = MAX17043_REG_SOC;
-    uint8_t data[2];
+    uint8_t reg = MAX17043_BURST_FIRST;
     int ret;
 
-    ret = i2c_write_read(i2c_dev, MAX17043_ADDR << 1, &reg, 1, data, 2);
+    if (snapshot.valid && k_uptime_get() - snapshot.read_ms < MAX17043_CACHE_MAX_AGE_MS) {
+        return 0;
+    }
+
+    ret = i2c_trace_write_read(i2c_dev, MAX17043_ADDR, &reg, 1,
+                               snapshot.regs, sizeof(snapshot.regs));
     if (ret != 0) {
+        snapshot.valid = false;
         LOG_ERR("MAX17043 read failed: %d", ret);
         return ret;
     }
 
-    uint16_t soc = (data[0] << 8) | data[1];
+    snapshot.read_ms = k_uptime_get();
+    snapshot.valid = true;
+
+    return 0;
+}
+
+static uint16_t snapshot_reg(uint8_t reg)
+{
+    return sys_get_be16(&snapshot.regs[BURST_OFFSET(reg)]);
+}
+
+static int write_reg(const struct device *i2c_dev, uint8_t reg, uint16_t value)
+{
+    uint8_t buf[3] = { reg };
+    struct i2c_msg msg = {
+        .buf = buf,
+        .len = sizeof(buf),
+        .flags = I2C_MSG_WRITE | I2C_MSG_STOP,
+    };
+
+    sys_put_be16(value, &buf[1]);
+
+    // Anything cached no longer reflects the device
+    snapshot.valid = false;
+
+    return i2c_trace_transfer(i2c_dev, &msg, 1, MAX17043_ADDR);
+}
+
+int max17043_init(const struct device *i2c_dev)
+{
+    int ret;
+
+    snapshot.valid = false;
+
+    ret = burst_read(i2c_dev);
+    if (ret != 0) {
+        return ret;
+    }
+
+    LOG_INF("MAX17043 version 0x%04x", snapshot_reg(MAX17043_REG_VERSION));
+    return 0;
+}
+
+int max17043_read(const struct device *i2c_dev, float *battery_level)
+{
+    int ret;
+
+    ret = burst_read(i2c_dev);
+    if (ret != 0) {
+        return ret;
+    }
+
+    uint16_t soc = snapshot_reg(MAX17043_REG_SOC);
     *battery_level = soc / 256.0f; // Use 'f' suffix for float literal
 
     LOG_INF("MAX17043 Battery Level: %d.%02d%%", 
             (int)*battery_level, 
             (int)((*battery_level - (int)*battery_level) * 100));
     return 0;
-}
\ No newline at end of file
+}
+
+int max17043_read_voltage(const struct device *i2c_dev, float *voltage)
+{
+    int ret;
+
+    ret = burst_read(i2c_dev);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // 12-bit reading, left aligned, 1.25 mV per LSB
+    uint16_t vcell = snapshot_reg(MAX17043_REG_VCELL) >> 4;
+    *voltage = vcell * 0.00125f;
+
+    return 0;
+}
+
+int max17043_quick_start(const struct device *i2c_dev)
+{
+    int ret;
+
+    ret = write_reg(i2c_dev, MAX17043_REG_MODE, MAX17043_CMD_QUICK_START);
+    if (ret != 0) {
+        LOG_ERR("MAX17043 quick start failed: %d", ret);
+    }
+
+    return ret;
+}
+
+int max17043_set_alert_threshold(const struct device *i2c_dev, uint8_t threshold)
+{
+    uint16_t config;
+    int ret;
+
+    if (threshold < 1 || threshold > 32) {
+        return -EINVAL;
+    }
+
+    ret = burst_read(i2c_dev);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // Keep RCOMP and SLEEP, clear ALRT, ATHD encodes 32 - threshold
+    config = snapshot_reg(MAX17043_REG_CONFIG);
+    config &= ~(MAX17043_CONFIG_ALRT | MAX17043_CONFIG_ATHD);
+    config |= (32 - threshold) & MAX17043_CONFIG_ATHD;
+
+    ret = write_reg(i2c_dev, MAX17043_REG_CONFIG, config);
+    if (ret != 0) {
+        LOG_ERR("MAX17043 alert threshold write failed: %d", ret);
+    }
+
+    return ret;
+}
+
+int max17043_get_alert_status(const struct device *i2c_dev, bool *alert_triggered)
+{
+    int ret;
+
+    ret = burst_read(i2c_dev);
+    if (ret != 0) {
+        return ret;
+    }
+
+    *alert_triggered = (snapshot_reg(MAX17043_REG_CONFIG) & MAX17043_CONFIG_ALRT) != 0;
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/logging/log.h>
+#include "config.h"
+#include "sensor_power.h"
+
+LOG_MODULE_REGISTER(sensor_power, LOG_LEVEL_INF);
+
+#define USER_NODE DT_PATH(zephyr_user)
+
+struct sensor_rail {
+    struct gpio_dt_spec gpio;
+    uint32_t warmup_ms;
+    int64_t ready_ms;         // uptime at which the rail is usable, 0 when off
+};
+
+static struct sensor_rail rails[SENSOR_COUNT] = {
+    [SENSOR_AHT10] = {
+        .gpio = GPIO_DT_SPEC_GET_OR(USER_NODE, aht10_pwr_gpios, {0}),
+        .warmup_ms = AHT10_WARMUP_MS,
+    },
+    [SENSOR_SOIL] = {
+        .gpio = GPIO_DT_SPEC_GET_OR(USER_NODE, soil_pwr_gpios, {0}),
+        .warmup_ms = SOIL_WARMUP_MS,
+    },
+    [SENSOR_LIGHT] = {
+        .gpio = GPIO_DT_SPEC_GET_OR(USER_NODE, light_pwr_gpios, {0}),
+        .warmup_ms = LIGHT_WARMUP_MS,
+    },
+};
+
+int sensor_power_init(void)
+{
+    int ret;
+
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        if (!sensor_power_is_gated(i)) {
+            continue;
+        }
+
+        if (!gpio_is_ready_dt(&rails[i].gpio)) {
+            LOG_ERR("Power GPIO for %s not ready", sensor_health_name(i));
+            return -ENODEV;
+        }
+
+        ret = gpio_pin_configure_dt(&rails[i].gpio, GPIO_OUTPUT_INACTIVE);
+        if (ret) {
+            LOG_ERR("Failed to configure power GPIO for %s: %d",
+                    sensor_health_name(i), ret);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+void sensor_power_on(uint32_t mask)
+{
+    int64_t now = k_uptime_get();
+
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        if (!(mask & BIT(i)) || !sensor_power_is_gated(i) || rails[i].ready_ms) {
+            continue;
+        }
+
+        gpio_pin_set_dt(&rails[i].gpio, 1);
+        rails[i].ready_ms = now + rails[i].warmup_ms;
+    }
+}
+
+void sensor_power_wait(enum sensor_id id)
+{
+    int64_t remaining;
+
+    if (!sensor_power_is_gated(id) || !rails[id].ready_ms) {
+        return;
+    }
+
+    remaining = rails[id].ready_ms - k_uptime_get();
+    if (remaining > 0) {
+        k_msleep(remaining);
+    }
+}
+
+bool sensor_power_is_gated(enum sensor_id id)
+{
+    return rails[id].gpio.port != NULL;
+}
+
+void sensor_power_off_all(void)
+{
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        if (!sensor_power_is_gated(i) || !rails[i].ready_ms) {
+            continue;
+        }
+
+        gpio_pin_set_dt(&rails[i].gpio, 0);
+        rails[i].ready_ms = 0;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef SENSOR_POWER_H
+#define SENSOR_POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensor_health.h"
+
+/**
+ * @brief Initialize the sensor power-enable GPIOs (all rails off)
+ *
+ * Rails without a *-pwr-gpios property in the zephyr,user node are treated
+ * as permanently powered.
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int sensor_power_init(void);
+
+/**
+ * @brief Switch on the rails of several sensors at once
+ *
+ * All requested rails start their warm-up together so the waits overlap.
+ *
+ * @param mask BIT(enum sensor_id) for each sensor to power
+ */
+void sensor_power_on(uint32_t mask);
+
+/**
+ * @brief Block until a sensor's rail has finished its warm-up time
+ *
+ * Returns immediately for sensors without a gated rail.
+ *
+ * @param id Sensor identifier
+ */
+void sensor_power_wait(enum sensor_id id);
+
+/**
+ * @brief Check whether a sensor sits on a switched rail
+ *
+ * @param id Sensor identifier
+ * @return true if the sensor is power gated
+ */
+bool sensor_power_is_gated(enum sensor_id id);
+
+/**
+ * @brief Switch off every gated rail
+ */
+void sensor_power_off_all(void);
+
+#endif /* SENSOR_POWER_H */
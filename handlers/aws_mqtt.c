@@ -1,58 +1,502 @@
-#include <zephyr.h>
-#include <net/mqtt.h>
-#include <net/socket.h>
-#include <sys/byteorder.h>
+#include <zephyr/kernel.h>
+#include <zephyr/net/mqtt.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/net/tls_credentials.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
 #include <string.h>
 #include <stdio.h>
+#include "config.h"
+#include "aws_mqtt.h"
+#include "histogram.h"
+#include "credentials.h"
 
-#define AWS_ENDPOINT "your_mqtt_broker_hostname"
+LOG_MODULE_REGISTER(aws_mqtt, LOG_LEVEL_INF);
 
 struct mqtt_client_ctx {
     struct mqtt_client client;
     struct sockaddr_in broker;
+    uint8_t rx_buffer[AWS_MQTT_BUFFER_SIZE];
+    uint8_t tx_buffer[AWS_MQTT_BUFFER_SIZE];
 };
 
 static struct mqtt_client_ctx client_ctx;
+static struct aws_mqtt_stats stats;
+static uint16_t next_message_id = 1;
+static bool connected;
+static aws_mqtt_puback_cb_t puback_cb;
+
+// Single subscription, renewed on every session
+static const char *sub_topic;
+static aws_mqtt_message_cb_t message_cb;
+static uint8_t rx_payload[AWS_MQTT_RX_PAYLOAD_MAX];
+
+// A kept session between uplinks belongs to the receive thread, which blocks
+// on the socket until a message arrives or the next ping is due. The caller
+// of aws_mqtt_connect() holds it until aws_mqtt_release()
+static bool held = true;
+static K_MUTEX_DEFINE(rx_lock);
+static K_SEM_DEFINE(rx_sem, 0, 1);
+
+// Send times of outstanding QoS1 messages, for the round-trip histogram
+static struct {
+    uint16_t message_id;
+    int64_t sent_ticks;
+} pending[AWS_MQTT_RTT_SLOTS];
+
+static void rtt_start(uint16_t message_id)
+{
+    static uint8_t next;
+
+    pending[next].message_id = message_id;
+    pending[next].sent_ticks = k_uptime_ticks();
+    next = (next + 1) % ARRAY_SIZE(pending);
+}
+
+static void rtt_stop(uint16_t message_id)
+{
+    for (int i = 0; i < ARRAY_SIZE(pending); i++) {
+        if (pending[i].message_id == message_id) {
+            histogram_record(HIST_PUBLISH_RTT,
+                             k_ticks_to_us_floor32(k_uptime_ticks() - pending[i].sent_ticks));
+            pending[i].message_id = 0;
+            return;
+        }
+    }
+}
+
+static sec_tag_t sec_tags[] = { AWS_SEC_TAG };
+
+static void handle_publish(const struct mqtt_publish_param *pub)
+{
+    size_t len = pub->message.payload.len;
+    size_t left = len;
+    int ret;
+
+    // The payload is still in the socket and must be consumed either way
+    while (left > 0) {
+        ret = mqtt_read_publish_payload_blocking(&client_ctx.client, rx_payload,
+                                                 MIN(left, sizeof(rx_payload)));
+        if (ret <= 0) {
+            LOG_ERR("Failed to read publish payload: %d", ret);
+            if (message_cb) {
+                message_cb(NULL, len, ret < 0 ? ret : -EIO);
+            }
+            return;
+        }
+        left -= ret;
+    }
+
+    if (pub->message.topic.qos == MQTT_QOS_1_AT_LEAST_ONCE) {
+        struct mqtt_puback_param ack = { .message_id = pub->message_id };
+
+        mqtt_publish_qos1_ack(&client_ctx.client, &ack);
+    }
+
+    stats.received++;
+
+    // An oversized message is still reported so a retained one gets cleared
+    if (len > sizeof(rx_payload)) {
+        LOG_WRN("Dropped %u byte message", (uint32_t)len);
+        if (message_cb) {
+            message_cb(NULL, len, -EMSGSIZE);
+        }
+        return;
+    }
+
+    if (message_cb) {
+        message_cb(rx_payload, len, 0);
+    }
+}
+
+static void mqtt_evt_handler(struct mqtt_client *client, const struct mqtt_evt *evt)
+{
+    switch (evt->type) {
+    case MQTT_EVT_CONNACK:
+        if (evt->result == 0) {
+            connected = true;
+            stats.connects++;
+        }
+        break;
+    case MQTT_EVT_DISCONNECT:
+        connected = false;
+        stats.disconnects++;
+        // Unacknowledged QoS1 messages are not resent after a new session
+        stats.inflight = 0;
+        break;
+    case MQTT_EVT_PUBACK:
+        stats.pubacks++;
+        rtt_stop(evt->param.puback.message_id);
+        if (stats.inflight > 0) {
+            stats.inflight--;
+        }
+        if (puback_cb) {
+            puback_cb(evt->param.puback.message_id, evt->result);
+        }
+        break;
+    case MQTT_EVT_PUBLISH:
+        if (evt->result == 0) {
+            handle_publish(&evt->param.publish);
+        }
+        break;
+    case MQTT_EVT_SUBACK:
+        if (evt->result) {
+            LOG_ERR("Subscription rejected: %d", evt->result);
+        }
+        break;
+    default:
+        break;
+    }
+}
 
 int aws_mqtt_init(void)
 {
+    struct mqtt_sec_config *tls = &client_ctx.client.transport.tls.config;
     int err;
 
-    struct sockaddr_in broker_addr;
-    broker_addr.sin_family = AF_INET;
-    broker_addr.sin_port = htons(CONFIG_MQTT_BROKER_PORT);
+    // Set up before anything can fail, so the client is always usable and a
+    // later connect reports the real error
+    mqtt_client_init(&client_ctx.client);
 
-    err = inet_pton(AF_INET, AWS_ENDPOINT, &broker_addr.sin_addr);
-    if (err <= 0) {
-        printk("Invalid broker address\n");
-        return -EINVAL;
+    client_ctx.client.broker = (struct sockaddr *)&client_ctx.broker;
+    client_ctx.client.evt_cb = mqtt_evt_handler;
+    client_ctx.client.client_id.utf8 = (uint8_t *)AWS_CLIENT_ID;
+    client_ctx.client.client_id.size = strlen(AWS_CLIENT_ID);
+    client_ctx.client.protocol_version = MQTT_VERSION_3_1_1;
+    client_ctx.client.rx_buf = client_ctx.rx_buffer;
+    client_ctx.client.rx_buf_size = sizeof(client_ctx.rx_buffer);
+    client_ctx.client.tx_buf = client_ctx.tx_buffer;
+    client_ctx.client.tx_buf_size = sizeof(client_ctx.tx_buffer);
+
+    client_ctx.client.transport.type = MQTT_TRANSPORT_SECURE;
+    tls->peer_verify = TLS_PEER_VERIFY_REQUIRED;
+    tls->sec_tag_list = sec_tags;
+    tls->sec_tag_count = ARRAY_SIZE(sec_tags);
+    tls->hostname = AWS_ENDPOINT;
+    // Resume the TLS session on reconnect instead of a full handshake
+    tls->session_cache = TLS_SESSION_CACHE_ENABLED;
+
+    // Device certificate, key and CA for the sec tag above
+    err = credentials_init();
+    if (err) {
+        LOG_ERR("Failed to set up TLS credentials: %d", err);
+        return err;
     }
 
-    client_ctx.broker = broker_addr;
-    client_ctx.client.broker = (struct sockaddr *)&client_ctx.broker;
-    client_ctx.client.broker_len = sizeof(struct sockaddr_in);
+    return 0;
+}
 
-    // Initialize MQTT client here
-    // ...
+void aws_mqtt_set_session_resumption(bool enable)
+{
+    client_ctx.client.transport.tls.config.session_cache =
+        enable ? TLS_SESSION_CACHE_ENABLED : TLS_SESSION_CACHE_DISABLED;
+}
+
+void aws_mqtt_set_keepalive(uint16_t keepalive_s)
+{
+    if (client_ctx.client.keepalive == keepalive_s) {
+        return;
+    }
+
+    client_ctx.client.keepalive = keepalive_s;
+
+    // The keepalive is negotiated in CONNECT, so start a new session with it
+    if (connected) {
+        mqtt_disconnect(&client_ctx.client);
+    }
+}
+
+static int subscribe(void)
+{
+    struct mqtt_topic topic = {
+        .topic.utf8 = (uint8_t *)sub_topic,
+        .topic.size = strlen(sub_topic),
+        .qos = MQTT_QOS_1_AT_LEAST_ONCE,
+    };
+    const struct mqtt_subscription_list list = {
+        .list = &topic,
+        .list_count = 1,
+        .message_id = aws_mqtt_next_message_id(),
+    };
+
+    return mqtt_subscribe(&client_ctx.client, &list);
+}
+
+// The endpoint is a host name, looked up on every connect so a changed
+// broker address is picked up without a reboot
+static int resolve_broker(void)
+{
+    struct zsock_addrinfo hints = {
+        .ai_family = AF_INET,
+        .ai_socktype = SOCK_STREAM,
+    };
+    struct zsock_addrinfo *res;
+    int ret;
+
+    ret = zsock_getaddrinfo(AWS_ENDPOINT, NULL, &hints, &res);
+    if (ret) {
+        LOG_ERR("Failed to resolve %s: %d", AWS_ENDPOINT, ret);
+        return -EHOSTUNREACH;
+    }
+
+    client_ctx.broker = *(struct sockaddr_in *)res->ai_addr;
+    client_ctx.broker.sin_port = htons(CONFIG_MQTT_BROKER_PORT);
+    zsock_freeaddrinfo(res);
 
     return 0;
 }
 
-int aws_mqtt_publish(const char *topic, const uint8_t *payload, size_t len)
+static int mqtt_socket(void)
+{
+    if (client_ctx.client.transport.type == MQTT_TRANSPORT_SECURE) {
+        return client_ctx.client.transport.tls.sock;
+    }
+
+    return client_ctx.client.transport.tcp.sock;
+}
+
+int aws_mqtt_connect(void)
+{
+    int64_t deadline;
+    int ret;
+
+    // Take the session back once the receive thread is done with a message
+    k_mutex_lock(&rx_lock, K_FOREVER);
+    held = true;
+    k_mutex_unlock(&rx_lock);
+
+    if (connected) {
+        return 0;
+    }
+
+    ret = resolve_broker();
+    if (ret) {
+        return ret;
+    }
+
+    ret = mqtt_connect(&client_ctx.client);
+    if (ret) {
+        LOG_ERR("MQTT connect failed: %d", ret);
+#if defined(CONFIG_MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+        // A broker that ignores MFL sends records these buffers cannot hold
+        LOG_WRN("If this persists, the broker may not honour Max Fragment Length; "
+                "build without overlay-tls-lowmem.conf");
+#endif
+        return ret;
+    }
+
+    // Wait for CONNACK
+    deadline = k_uptime_get() + AWS_MQTT_CONNECT_TIMEOUT_MS;
+    while (!connected && k_uptime_get() < deadline) {
+        ret = aws_mqtt_process(deadline - k_uptime_get());
+        if (ret < 0) {
+            break;
+        }
+    }
+
+    if (!connected) {
+        LOG_ERR("No CONNACK from broker");
+        mqtt_abort(&client_ctx.client);
+        return ret < 0 ? ret : -ETIMEDOUT;
+    }
+
+    // Clean sessions forget subscriptions; retained messages arrive right after
+    if (sub_topic) {
+        ret = subscribe();
+        if (ret) {
+            LOG_ERR("Failed to subscribe to %s: %d", sub_topic, ret);
+        }
+    }
+
+    return 0;
+}
+
+int aws_mqtt_disconnect(void)
+{
+    if (!connected) {
+        return 0;
+    }
+
+    return mqtt_disconnect(&client_ctx.client);
+}
+
+void aws_mqtt_release(void)
+{
+    held = false;
+
+    if (connected) {
+        k_sem_give(&rx_sem);
+    }
+}
+
+bool aws_mqtt_is_connected(void)
+{
+    return connected;
+}
+
+static int service(const struct zsock_pollfd *fd)
+{
+    int ret;
+
+    if (fd->revents & ZSOCK_POLLIN) {
+        ret = mqtt_input(&client_ctx.client);
+        if (ret) {
+            return ret;
+        }
+    }
+
+    if (fd->revents & (ZSOCK_POLLERR | ZSOCK_POLLHUP | ZSOCK_POLLNVAL)) {
+        return -ENOTCONN;
+    }
+
+    ret = mqtt_live(&client_ctx.client);
+    if (ret && ret != -EAGAIN) {
+        return ret;
+    }
+
+    return 0;
+}
+
+int aws_mqtt_process(int timeout_ms)
+{
+    struct zsock_pollfd fd = {
+        .fd = mqtt_socket(),
+        .events = ZSOCK_POLLIN,
+    };
+    int ret;
+
+    ret = zsock_poll(&fd, 1, MAX(timeout_ms, 0));
+    if (ret < 0) {
+        return -errno;
+    }
+
+    return service(&fd);
+}
+
+static void rx_thread(void *p1, void *p2, void *p3)
+{
+    struct zsock_pollfd fd;
+    uint32_t left_ms;
+    int ret;
+
+    while (true) {
+        k_sem_take(&rx_sem, K_FOREVER);
+
+        while (connected && !held) {
+            left_ms = mqtt_keepalive_time_left(&client_ctx.client);
+            fd.fd = mqtt_socket();
+            fd.events = ZSOCK_POLLIN;
+            fd.revents = 0;
+
+            // Wakes for a message at once, otherwise when the ping is due
+            ret = zsock_poll(&fd, 1, left_ms == UINT32_MAX ? -1 : left_ms);
+            if (ret < 0) {
+                ret = -errno;
+            }
+
+            k_mutex_lock(&rx_lock, K_FOREVER);
+            if (held || !connected) {
+                // Claimed while waiting: the holder reads from here on
+                k_mutex_unlock(&rx_lock);
+                break;
+            }
+            if (ret >= 0) {
+                ret = service(&fd);
+            }
+            if (ret) {
+                LOG_WRN("Kept session failed: %d", ret);
+                mqtt_abort(&client_ctx.client);
+            }
+            k_mutex_unlock(&rx_lock);
+        }
+    }
+}
+
+K_THREAD_DEFINE(aws_mqtt_rx, AWS_MQTT_RX_STACK_SIZE, rx_thread, NULL, NULL, NULL,
+                AWS_MQTT_RX_PRIORITY, 0, 0);
+
+void aws_mqtt_set_puback_handler(aws_mqtt_puback_cb_t cb)
+{
+    puback_cb = cb;
+}
+
+int aws_mqtt_subscribe(const char *topic, aws_mqtt_message_cb_t cb)
+{
+    sub_topic = topic;
+    message_cb = cb;
+
+    if (!connected) {
+        return 0;
+    }
+
+    return subscribe();
+}
+
+int aws_mqtt_clear_retained(const char *topic)
+{
+    struct mqtt_publish_param param = {
+        .message.topic.qos = MQTT_QOS_0_AT_MOST_ONCE,
+        .message.topic.topic.utf8 = (uint8_t *)topic,
+        .message.topic.topic.size = strlen(topic),
+        .retain_flag = 1,
+    };
+
+    // A zero-length retained message deletes the stored one
+    return mqtt_publish(&client_ctx.client, &param);
+}
+
+uint16_t aws_mqtt_next_message_id(void)
+{
+    uint16_t id = next_message_id++;
+
+    // Message identifier 0 is reserved
+    if (next_message_id == 0) {
+        next_message_id = 1;
+    }
+
+    return id;
+}
+
+int aws_mqtt_send(const char *topic, const uint8_t *payload, size_t len,
+                  uint8_t qos, uint16_t message_id, bool dup)
 {
     struct mqtt_publish_param param;
+    int ret;
 
-    param.message.topic.qos = MQTT_QOS_1_AT_LEAST_ONCE;
+    param.message.topic.qos = qos;
     param.message.topic.topic.utf8 = (uint8_t *)topic;
     param.message.topic.topic.size = strlen(topic);
     param.message.payload.data = (uint8_t *)payload;
     param.message.payload.len = len;
-    param.message.payload.offset = 0;
-    param.topic.topic = NULL;
-    param.message_id = 0;
-    param.message.topic.type = MQTT_TOPIC_UTF8;
-    param.dupflag = 0;
-    param.retain = 0;
+    param.message_id = message_id;
+    param.dup_flag = dup;
+    param.retain_flag = 0;
 
-    return mqtt_publish(&client_ctx.client, &param);
-}
\ No newline at end of file
+    ret = mqtt_publish(&client_ctx.client, &param);
+    if (ret) {
+        stats.publish_errors++;
+        return ret;
+    }
+
+    stats.published++;
+    stats.tx_bytes += len;
+    if (dup) {
+        stats.retransmits++;
+    }
+    if (qos == MQTT_QOS_1_AT_LEAST_ONCE && !dup) {
+        stats.inflight++;
+        rtt_start(message_id);
+    }
+
+    return 0;
+}
+
+int aws_mqtt_publish(const char *topic, const uint8_t *payload, size_t len, uint8_t qos)
+{
+    return aws_mqtt_send(topic, payload, len, qos, aws_mqtt_next_message_id(), false);
+}
+
+const struct aws_mqtt_stats *aws_mqtt_get_stats(void)
+{
+    return &stats;
+}
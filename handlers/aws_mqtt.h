@@ -0,0 +1,175 @@
+#ifndef AWS_MQTT_H
+#define AWS_MQTT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// MQTT link counters
+struct aws_mqtt_stats {
+    uint32_t published;
+    uint32_t publish_errors;
+    uint32_t pubacks;
+    uint32_t inflight;        // QoS1 messages still waiting for PUBACK
+    uint32_t connects;
+    uint32_t disconnects;
+    uint32_t received;        // Messages on the subscribed topic
+    uint32_t retransmits;     // Publishes resent with DUP set
+    uint32_t tx_bytes;        // Payload bytes handed to the socket
+};
+
+/**
+ * @brief Callback for PUBACKs
+ *
+ * @param message_id Identifier of the acknowledged message
+ * @param result 0 on success, MQTT error code otherwise
+ */
+typedef void (*aws_mqtt_puback_cb_t)(uint16_t message_id, int result);
+
+/**
+ * @brief Callback for messages received on the subscribed topic
+ *
+ * Runs in the MQTT event handler, on the receive thread while a kept session
+ * is released, so it must not call back into the client other than to
+ * publish.
+ *
+ * @param payload Message payload, NULL if it could not be received
+ * @param len Payload length
+ * @param result 0, or -EMSGSIZE / negative errno if the payload was dropped
+ */
+typedef void (*aws_mqtt_message_cb_t)(const uint8_t *payload, size_t len, int result);
+
+/**
+ * @brief Initialize the MQTT client
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int aws_mqtt_init(void);
+
+/**
+ * @brief Connect to the broker and wait for CONNACK
+ *
+ * Also takes an established session back from the receive thread; the
+ * caller then services it with aws_mqtt_process() until aws_mqtt_release().
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int aws_mqtt_connect(void);
+
+/**
+ * @brief Hand a kept session to the receive thread
+ *
+ * The thread blocks on the socket, so messages are delivered as they arrive
+ * and the keepalive ping is sent when due, until the next aws_mqtt_connect().
+ */
+void aws_mqtt_release(void);
+
+/**
+ * @brief Disconnect from the broker
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int aws_mqtt_disconnect(void);
+
+/**
+ * @brief Set the keepalive used for the next session
+ *
+ * Drops the current session if the value changes.
+ *
+ * @param keepalive_s Keepalive in seconds
+ */
+void aws_mqtt_set_keepalive(uint16_t keepalive_s);
+
+/**
+ * @brief Enable or disable TLS session resumption for the next connect
+ *
+ * Resumption is on by default; benchmarks turn it off to time full handshakes.
+ *
+ * @param enable true to resume cached TLS sessions
+ */
+void aws_mqtt_set_session_resumption(bool enable);
+
+/**
+ * @brief Check whether a session is established
+ *
+ * @return true if connected
+ */
+bool aws_mqtt_is_connected(void);
+
+/**
+ * @brief Wait for incoming data, process it and keep the session alive
+ *
+ * @param timeout_ms Maximum time to wait for incoming data
+ * @return 0 on success, negative errno on failure
+ */
+int aws_mqtt_process(int timeout_ms);
+
+/**
+ * @brief Register the PUBACK callback
+ *
+ * @param cb Callback, or NULL to remove it
+ */
+void aws_mqtt_set_puback_handler(aws_mqtt_puback_cb_t cb);
+
+/**
+ * @brief Subscribe to a topic on every session
+ *
+ * Messages are delivered from aws_mqtt_process() while the session is held,
+ * and by the receive thread as soon as they arrive once it is released.
+ *
+ * @param topic Null-terminated topic, must stay valid
+ * @param cb Callback for received messages
+ * @return 0 on success, negative errno on failure
+ */
+int aws_mqtt_subscribe(const char *topic, aws_mqtt_message_cb_t cb);
+
+/**
+ * @brief Remove the retained message of a topic
+ *
+ * @param topic Null-terminated topic
+ * @return 0 on success, negative errno on failure
+ */
+int aws_mqtt_clear_retained(const char *topic);
+
+/**
+ * @brief Allocate the next MQTT message identifier
+ *
+ * @return Message identifier (never 0)
+ */
+uint16_t aws_mqtt_next_message_id(void);
+
+/**
+ * @brief Publish a message with an explicit identifier
+ *
+ * Used for retransmissions, which must reuse the identifier and set DUP.
+ *
+ * @param topic Null-terminated topic
+ * @param payload Message payload
+ * @param len Payload length
+ * @param qos MQTT QoS level (enum mqtt_qos)
+ * @param message_id Message identifier
+ * @param dup true for a retransmission
+ * @return 0 on success, negative errno on failure
+ */
+int aws_mqtt_send(const char *topic, const uint8_t *payload, size_t len,
+                  uint8_t qos, uint16_t message_id, bool dup);
+
+/**
+ * @brief Publish a message
+ *
+ * @param topic Null-terminated topic
+ * @param payload Message payload
+ * @param len Payload length
+ * @param qos MQTT QoS level (enum mqtt_qos)
+ * @return 0 on success, negative errno on failure
+ */
+int aws_mqtt_publish(const char *topic, const uint8_t *payload, size_t len, uint8_t qos);
+
+/**
+ * @brief Get the MQTT link counters
+ *
+ * @return Pointer to the counters
+ */
+const struct aws_mqtt_stats *aws_mqtt_get_stats(void);
+
+#endif /* AWS_MQTT_H */
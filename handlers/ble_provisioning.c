@@ -1,31 +1,270 @@
-#include <zephyr.h>
-#include <bluetooth/bluetooth.h>
-#include <bluetooth/uuid.h>
-#include <bluetooth/gatt.h>
-#include <sys/printk.h>
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/sys/printk.h>
+
+#include "config.h"
+#include "credentials.h"
+#include "ble_provisioning.h"
+
+#define BT_UUID_WIFI_PROV_VAL \
+    BT_UUID_128_ENCODE(0x6f1c0001, 0x5a2e, 0x4b8e, 0x9d3c, 0x2b7f10a4c0de)
+#define BT_UUID_PROV_CRED_VAL \
+    BT_UUID_128_ENCODE(0x6f1c0002, 0x5a2e, 0x4b8e, 0x9d3c, 0x2b7f10a4c0de)
 
 static struct bt_uuid_128 wifi_prov_uuid = BT_UUID_INIT_128(BT_UUID_WIFI_PROV_VAL);
+static struct bt_uuid_128 prov_cred_uuid = BT_UUID_INIT_128(BT_UUID_PROV_CRED_VAL);
+
+// Credential being received over the credential characteristic
+static uint8_t cred_rx_type = CRED_TYPE_COUNT;
+static size_t cred_rx_len;
+
+/*
+ * Each write is [type][PEM chunk], chunks in order. A write of the type byte
+ * alone validates and stores what was received, so RSA or EC P-256 device
+ * credentials can be provisioned alongside Wi-Fi.
+ */
+static ssize_t write_cred(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                          const void *buf, uint16_t len, uint16_t offset, uint8_t flags)
+{
+    const uint8_t *data = buf;
+    uint8_t type;
+    int err;
+
+    if (offset != 0 || len < 1) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+    }
+
+    type = data[0];
+    if (type >= CRED_TYPE_COUNT) {
+        return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+    }
+
+    if (type != cred_rx_type) {
+        cred_rx_type = type;
+        cred_rx_len = 0;
+    }
+
+    if (len == 1) {
+        err = credentials_commit(type, cred_rx_len);
+        cred_rx_type = CRED_TYPE_COUNT;
+        cred_rx_len = 0;
+        if (err) {
+            printk("Rejected credential %u (err %d)\n", type, err);
+            return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+        }
+        return len;
+    }
+
+    err = credentials_write(type, cred_rx_len, data + 1, len - 1);
+    if (err) {
+        cred_rx_type = CRED_TYPE_COUNT;
+        return BT_GATT_ERR(BT_ATT_ERR_INSUFFICIENT_RESOURCES);
+    }
+    cred_rx_len += len - 1;
+
+    return len;
+}
+
+BT_GATT_SERVICE_DEFINE(prov_svc,
+    BT_GATT_PRIMARY_SERVICE(&wifi_prov_uuid),
+    BT_GATT_CHARACTERISTIC(&prov_cred_uuid.uuid, BT_GATT_CHRC_WRITE,
+                           BT_GATT_PERM_WRITE_ENCRYPT, NULL, write_cred, NULL),
+);
+
+static const struct bt_le_adv_param adv_param = {
+    .options = BT_LE_ADV_OPT_USE_NAME | BT_LE_ADV_OPT_CONNECTABLE,
+    .interval_min = BT_GAP_ADV_FAST_INT_MIN_2,
+    .interval_max = BT_GAP_ADV_FAST_INT_MAX_2,
+};
+
+// Connection events while BLE has the radio, and while Wi-Fi has it
+static const struct bt_le_conn_param conn_param_fast = {
+    .interval_min = BT_GAP_INIT_CONN_INT_MIN,
+    .interval_max = BT_GAP_INIT_CONN_INT_MAX,
+    .latency = 0,
+    .timeout = 400,
+};
+
+static const struct bt_le_conn_param conn_param_yield = {
+    .interval_min = COEX_YIELD_CONN_INTERVAL,
+    .interval_max = COEX_YIELD_CONN_INTERVAL,
+    .latency = 0,
+    .timeout = COEX_YIELD_CONN_TIMEOUT,
+};
+
+static bool enabled;
+static bool adv_wanted;      // Requested by the power tier
+static bool advertising;     // Actually running
+static bool yielded;         // Wi-Fi uplink window in progress
+static struct bt_conn *prov_conn;
+
+static struct ble_coex_stats coex_stats;
+static int64_t yield_start_ms;
+
+static int update_advertising(void)
+{
+    bool run = enabled && adv_wanted && !yielded && !prov_conn;
+    int err;
+
+    if (run == advertising) {
+        return 0;
+    }
+
+    if (run) {
+        err = bt_le_adv_start(&adv_param, NULL, 0, NULL, 0);
+    } else {
+        err = bt_le_adv_stop();
+    }
+
+    if (err) {
+        printk("Failed to %s advertising (err %d)\n", run ? "start" : "stop", err);
+        return err;
+    }
+
+    advertising = run;
+    return 0;
+}
+
+static void connected(struct bt_conn *conn, uint8_t err)
+{
+    if (err) {
+        return;
+    }
+
+    // Connectable advertising stops when a central connects
+    prov_conn = bt_conn_ref(conn);
+    advertising = false;
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+    if (conn != prov_conn) {
+        return;
+    }
+
+    bt_conn_unref(prov_conn);
+    prov_conn = NULL;
+}
+
+static void recycled(void)
+{
+    update_advertising();
+}
+
+BT_CONN_CB_DEFINE(conn_callbacks) = {
+    .connected = connected,
+    .disconnected = disconnected,
+    .recycled = recycled,
+};
 
 int ble_provisioning_init(void)
 {
-    struct bt_le_adv_param adv_param = {
-        .options = BT_LE_ADV_OPT_USE_NAME | BT_LE_ADV_OPT_CONNECTABLE,
-        .interval_min = BT_GAP_ADV_FAST_INT_MIN_2,
-        .interval_max = BT_GAP_ADV_FAST_INT_MAX_2,
-    };
+    int err;
 
-    int err = bt_enable(NULL);
+    if (enabled) {
+        return 0;
+    }
+
+    err = bt_enable(NULL);
     if (err) {
         printk("Bluetooth init failed (err %d)\n", err);
         return err;
     }
+    enabled = true;
+    adv_wanted = true;
 
-    err = bt_le_adv_start(&adv_param, NULL, 0, NULL, 0);
+    err = update_advertising();
     if (err) {
-        printk("Advertising failed to start (err %d)\n", err);
         return err;
     }
 
     printk("Bluetooth Advertising successfully started\n");
     return 0;
-}
\ No newline at end of file
+}
+
+int ble_provisioning_deinit(void)
+{
+    int err;
+
+    if (!enabled) {
+        return 0;
+    }
+
+    if (advertising) {
+        bt_le_adv_stop();
+        advertising = false;
+    }
+
+    // Shuts down the host and the controller
+    err = bt_disable();
+    if (err) {
+        printk("Bluetooth disable failed (err %d)\n", err);
+        return err;
+    }
+
+    // No disconnected callback comes after bt_disable(); drop the reference
+    // here or the stale connection would block advertising after re-enabling
+    if (prov_conn) {
+        bt_conn_unref(prov_conn);
+        prov_conn = NULL;
+    }
+
+    enabled = false;
+    yielded = false;
+    printk("Bluetooth disabled\n");
+    return 0;
+}
+
+bool ble_provisioning_is_enabled(void)
+{
+    return enabled;
+}
+
+int ble_provisioning_set_advertising(bool enable)
+{
+    // Once torn down, only ble_provisioning_init() brings BLE back
+    adv_wanted = enable;
+
+    return update_advertising();
+}
+
+void ble_provisioning_yield(bool yield)
+{
+    uint32_t held_ms;
+
+    if (yield == yielded || !enabled) {
+        return;
+    }
+
+    yielded = yield;
+
+    if (yield) {
+        yield_start_ms = k_uptime_get();
+        coex_stats.windows++;
+        if (prov_conn) {
+            // Keep the link but leave long gaps for Wi-Fi
+            coex_stats.contended++;
+            bt_conn_le_param_update(prov_conn, &conn_param_yield);
+        }
+        update_advertising();
+        return;
+    }
+
+    held_ms = k_uptime_get() - yield_start_ms;
+    coex_stats.yield_ms += held_ms;
+    coex_stats.max_yield_ms = MAX(coex_stats.max_yield_ms, held_ms);
+
+    // Wi-Fi is idle until the next uplink, give BLE the radio back
+    if (prov_conn) {
+        bt_conn_le_param_update(prov_conn, &conn_param_fast);
+    }
+    update_advertising();
+}
+
+const struct ble_coex_stats *ble_provisioning_coex_stats(void)
+{
+    return &coex_stats;
+}
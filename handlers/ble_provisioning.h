@@ -0,0 +1,63 @@
+#ifndef BLE_PROVISIONING_H
+#define BLE_PROVISIONING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Radio time handed from BLE to Wi-Fi uplinks
+struct ble_coex_stats {
+    uint32_t windows;         // Uplink windows BLE yielded to
+    uint32_t contended;       // Windows that overlapped a provisioning connection
+    uint32_t yield_ms;        // Total time advertising was held off
+    uint32_t max_yield_ms;
+};
+
+/**
+ * @brief Enable Bluetooth and start provisioning advertising
+ *
+ * Can be called again after ble_provisioning_deinit() to re-provision.
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int ble_provisioning_init(void);
+
+/**
+ * @brief Tear down the Bluetooth stack once provisioning is done
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int ble_provisioning_deinit(void);
+
+/**
+ * @brief Check whether the Bluetooth stack is up
+ *
+ * @return true if enabled
+ */
+bool ble_provisioning_is_enabled(void);
+
+/**
+ * @brief Start or stop provisioning advertising
+ *
+ * @param enable true to advertise, false to stop
+ * @return 0 on success, negative errno on failure
+ */
+int ble_provisioning_set_advertising(bool enable);
+
+/**
+ * @brief Hand the shared radio to a Wi-Fi uplink, or take it back
+ *
+ * While yielded, advertising is paused and a provisioning connection is
+ * slowed to long connection intervals. Both return to full rate afterwards.
+ *
+ * @param yield true at the start of an uplink window, false at its end
+ */
+void ble_provisioning_yield(bool yield);
+
+/**
+ * @brief Get the coexistence counters
+ *
+ * @return Pointer to the counters
+ */
+const struct ble_coex_stats *ble_provisioning_coex_stats(void);
+
+#endif /* BLE_PROVISIONING_H */
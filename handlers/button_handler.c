@@ -1,19 +1,45 @@
-#include <zephyr.h>
-#include <drivers/gpio.h>
-#include <sys/printk.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/printk.h>
 
-// Define BUTTON_DEBOUNCE_TIME as a uint32_t representing milliseconds
-#define BUTTON_DEBOUNCE_TIME 200
+#include "config.h"
+
+// Debounce window in milliseconds
+#define BUTTON_DEBOUNCE_MS 200
 
 static uint32_t last_press_time = 0;
+static struct gpio_callback button_cb_data;
 
 void button_pressed_cb(const struct device *dev, struct gpio_callback *cb, uint32_t pins)
 {
     uint32_t current_time = k_uptime_get_32();
 
-    if ((current_time - last_press_time) > BUTTON_DEBOUNCE_TIME) {
+    if ((current_time - last_press_time) > BUTTON_DEBOUNCE_MS) {
         printk("Button pressed at %u ms\n", current_time);
         last_press_time = current_time;
         // Handle button press event
     }
 }
+
+void button_init(void)
+{
+    const struct device *gpio = DEVICE_DT_GET(DT_NODELABEL(gpio0));
+    int err;
+
+    if (!device_is_ready(gpio)) {
+        printk("Button GPIO device not ready\n");
+        return;
+    }
+
+    err = gpio_pin_configure(gpio, BUTTON_GPIO_PIN, GPIO_INPUT | GPIO_PULL_UP);
+    if (err == 0) {
+        err = gpio_pin_interrupt_configure(gpio, BUTTON_GPIO_PIN, GPIO_INT_EDGE_FALLING);
+    }
+    if (err) {
+        printk("Failed to configure button (err %d)\n", err);
+        return;
+    }
+
+    gpio_init_callback(&button_cb_data, button_pressed_cb, BIT(BUTTON_GPIO_PIN));
+    gpio_add_callback(gpio, &button_cb_data);
+}
@@ -0,0 +1,74 @@
+#ifndef CREDENTIALS_H
+#define CREDENTIALS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Device credentials held in the store
+enum cred_type {
+    CRED_DEVICE_CERT,
+    CRED_PRIVATE_KEY,
+    CRED_TYPE_COUNT
+};
+
+// Algorithm of the device private key
+enum cred_key_type {
+    CRED_KEY_NONE,
+    CRED_KEY_RSA,
+    CRED_KEY_EC_P256,
+};
+
+/**
+ * @brief Load the device credentials and register them for TLS
+ *
+ * Credentials provisioned into settings take precedence over the ones built
+ * from resources/. Must be called after settings_load().
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int credentials_init(void);
+
+/**
+ * @brief Write part of a credential being provisioned
+ *
+ * Chunks go into a staging buffer; the registered credentials are not
+ * touched until a complete pair has been committed.
+ *
+ * @param type Credential type
+ * @param offset Offset of the chunk in the PEM data
+ * @param data Chunk
+ * @param len Chunk length
+ * @return 0 on success, -ENOMEM if the credential does not fit
+ */
+int credentials_write(enum cred_type type, size_t offset, const uint8_t *data, size_t len);
+
+/**
+ * @brief Validate a written credential and complete the staged pair
+ *
+ * Private keys must be RSA or EC on the P-256 curve, PEM encoded (PKCS#1,
+ * SEC1 or PKCS#8). Once both the certificate and the key have been
+ * committed, the pair is registered and persisted together and used from
+ * the next connect. A rejected credential leaves the registered pair as is.
+ *
+ * @param type Credential type
+ * @param len Total length of the PEM data, without a terminator
+ * @return 0 on success, -ENOTSUP for an unsupported key, negative errno otherwise
+ */
+int credentials_commit(enum cred_type type, size_t len);
+
+/**
+ * @brief Get the algorithm of the registered device key
+ *
+ * @return Key type, CRED_KEY_NONE without a key
+ */
+enum cred_key_type credentials_key_type(void);
+
+/**
+ * @brief Get a printable name of a key type
+ *
+ * @param type Key type
+ * @return Name string
+ */
+const char *credentials_key_name(enum cred_key_type type);
+
+#endif /* CREDENTIALS_H */
@@ -0,0 +1,149 @@
+#include <zephyr/kernel.h>
+#include <zephyr/data/json.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+#include <stdio.h>
+#include "config.h"
+#include "app.h"
+#include "aws_mqtt.h"
+#include "mqtt_commands.h"
+
+LOG_MODULE_REGISTER(mqtt_commands, LOG_LEVEL_INF);
+
+struct command {
+    const char *cmd;
+    int32_t value;
+};
+
+static const struct json_obj_descr command_descr[] = {
+    JSON_OBJ_DESCR_PRIM(struct command, cmd, JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(struct command, value, JSON_TOK_NUMBER),
+};
+
+enum command_op {
+    COMMAND_NONE,
+    COMMAND_SAMPLE,
+    COMMAND_FLUSH,
+    COMMAND_INTERVAL,
+};
+
+static char cmd_topic[128];
+static uint32_t executed;
+
+// Commands arrive inside the MQTT event handler; run them from the workqueue
+// once the current cycle has finished with the client
+static struct k_work cmd_work;
+static enum command_op pending_op;
+static int32_t pending_value;
+
+static void cmd_work_handler(struct k_work *work)
+{
+    enum command_op op = pending_op;
+    int ret = 0;
+
+    pending_op = COMMAND_NONE;
+
+    switch (op) {
+    case COMMAND_SAMPLE:
+        app_sample_now();
+        break;
+    case COMMAND_FLUSH:
+        app_flush_cache();
+        break;
+    case COMMAND_INTERVAL:
+        ret = app_set_polling_interval(pending_value * 1000U);
+        break;
+    default:
+        return;
+    }
+
+    if (ret) {
+        LOG_ERR("Command %d failed: %d", op, ret);
+        return;
+    }
+
+    executed++;
+}
+
+static void on_message(const uint8_t *payload, size_t len, int result)
+{
+    char buf[COMMAND_PAYLOAD_MAX + 1];
+    struct command cmd = {0};
+    int ret;
+
+    // Our own clear of the retained command comes back empty
+    if (len == 0) {
+        return;
+    }
+
+    if (result || len > COMMAND_PAYLOAD_MAX) {
+        LOG_WRN("Command not received (%u bytes): %d", (uint32_t)len, result);
+        goto clear;
+    }
+
+    memcpy(buf, payload, len);
+    buf[len] = '\0';
+
+    ret = json_obj_parse(buf, len, command_descr, ARRAY_SIZE(command_descr), &cmd);
+    if (ret < 0 || !(ret & BIT(0))) {
+        LOG_WRN("Malformed command: %d", ret);
+        goto clear;
+    }
+
+    if (strcmp(cmd.cmd, "sample") == 0) {
+        pending_op = COMMAND_SAMPLE;
+    } else if (strcmp(cmd.cmd, "flush") == 0) {
+        pending_op = COMMAND_FLUSH;
+    } else if (strcmp(cmd.cmd, "interval") == 0 && (ret & BIT(1))) {
+        // Checked in seconds: scaling a negative or huge value could wrap into range
+        if (cmd.value < POLLING_INTERVAL_MIN / 1000 || cmd.value > POLLING_INTERVAL_MAX / 1000) {
+            LOG_WRN("Interval out of range: %d s", cmd.value);
+            goto clear;
+        }
+        pending_op = COMMAND_INTERVAL;
+        pending_value = cmd.value;
+    } else {
+        LOG_WRN("Unknown command: %s", cmd.cmd);
+        goto clear;
+    }
+
+    LOG_INF("Command: %s", cmd.cmd);
+    k_work_submit(&cmd_work);
+
+clear:
+    // Handled or not, do not see it again at the next wake
+    ret = aws_mqtt_clear_retained(cmd_topic);
+    if (ret) {
+        LOG_WRN("Failed to clear retained command: %d", ret);
+    }
+}
+
+int mqtt_commands_init(const char *plant_id)
+{
+    int ret;
+
+    ret = snprintf(cmd_topic, sizeof(cmd_topic), "%s%s/cmd", MQTT_PUBLISH_TOPIC, plant_id);
+    if (ret < 0 || ret >= sizeof(cmd_topic)) {
+        return -ENOMEM;
+    }
+
+    k_work_init(&cmd_work, cmd_work_handler);
+
+    return aws_mqtt_subscribe(cmd_topic, on_message);
+}
+
+void mqtt_commands_listen(uint32_t window_ms)
+{
+    int64_t deadline = k_uptime_get() + window_ms;
+
+    while (aws_mqtt_is_connected() && k_uptime_get() < deadline) {
+        if (aws_mqtt_process(deadline - k_uptime_get()) < 0) {
+            break;
+        }
+    }
+}
+
+uint32_t mqtt_commands_count(void)
+{
+    return executed;
+}
@@ -0,0 +1,36 @@
+#ifndef MQTT_COMMANDS_H
+#define MQTT_COMMANDS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Subscribe to the command topic of a plant
+ *
+ * Commands are JSON objects on <MQTT_PUBLISH_TOPIC><plant_id>/cmd:
+ *   {"cmd":"sample"}                 sample and publish now
+ *   {"cmd":"flush"}                  sample, publish and drain the offline cache
+ *   {"cmd":"interval","value":300}   set the polling interval in seconds
+ *
+ * Publishing them retained lets a sleeping device pick them up at its next
+ * wake; the device clears the retained message once it has been handled.
+ *
+ * @param plant_id Null-terminated plant identifier
+ * @return 0 on success, negative errno on failure
+ */
+int mqtt_commands_init(const char *plant_id);
+
+/**
+ * @brief Keep the session open for commands after an uplink
+ *
+ * @param window_ms Time to wait for incoming commands
+ */
+void mqtt_commands_listen(uint32_t window_ms);
+
+/**
+ * @brief Get the number of commands executed
+ *
+ * @return Commands executed since boot
+ */
+uint32_t mqtt_commands_count(void);
+
+#endif /* MQTT_COMMANDS_H */
@@ -0,0 +1,349 @@
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "app.h"
+#include "aws_mqtt.h"
+#include "data_cache.h"
+#include "qos_policy.h"
+#include "link_policy.h"
+#include "link_quality.h"
+#include "tx_power.h"
+#include "power_policy.h"
+#include "charge_monitor.h"
+#include "histogram.h"
+#include "diagnostics.h"
+#include "ble_provisioning.h"
+#include "mqtt_commands.h"
+#include "sensor_health.h"
+#include "sensor_filter.h"
+#include "soil_forecast.h"
+#include "watering.h"
+#include "adc_sampler.h"
+#include "i2c_trace.h"
+
+static int cmd_sample(const struct shell *sh, size_t argc, char **argv)
+{
+    app_sample_now();
+    shell_print(sh, "Sample triggered");
+
+    return 0;
+}
+
+static int cmd_stats(const struct shell *sh, size_t argc, char **argv)
+{
+    shell_print(sh, "stage      count  last_us   max_us   avg_us");
+    for (int i = 0; i < APP_STAGE_COUNT; i++) {
+        const struct app_stage_stats *st = app_get_stage_stats(i);
+
+        shell_print(sh, "%-8s  %6u  %7u  %7u  %7u",
+                    app_stage_name(i), st->count, st->last_us, st->max_us,
+                    st->count ? (uint32_t)(st->total_us / st->count) : 0);
+    }
+
+    return 0;
+}
+
+static int cmd_hist(const struct shell *sh, size_t argc, char **argv)
+{
+    struct histogram_snapshot snap;
+
+    for (int i = 0; i < HIST_COUNT; i++) {
+        histogram_get(i, &snap);
+        shell_print(sh, "%s: %u samples, max %u us", histogram_name(i), snap.count, snap.max_us);
+
+        for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            if (snap.buckets[b] == 0) {
+                continue;
+            }
+            shell_print(sh, "  %s%8u us  %u",
+                        b == HISTOGRAM_BUCKETS - 1 ? ">=" : "< ",
+                        b == HISTOGRAM_BUCKETS - 1 ? (1U << (b - 1)) << snap.shift
+                                                   : (1U << b) << snap.shift,
+                        snap.buckets[b]);
+        }
+    }
+
+    return 0;
+}
+
+static int cmd_sensors(const struct shell *sh, size_t argc, char **argv)
+{
+    shell_print(sh, "sensor     ok    fail  consec  state     last_us  max_us");
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        const struct sensor_health *h = sensor_health_get(i);
+
+        shell_print(sh, "%-8s  %6u  %5u  %6u  %-8s  %7u  %6u",
+                    sensor_health_name(i), h->successes, h->failures,
+                    h->consecutive_failures, h->disabled ? "disabled" : "ok",
+                    h->last_latency_us, h->max_latency_us);
+    }
+
+    return 0;
+}
+
+static int cmd_filter(const struct shell *sh, size_t argc, char **argv)
+{
+    shell_print(sh, "sensor    accepted  rejected  median  avg_cyc  max_cyc");
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        const struct sensor_filter_stats *st = sensor_filter_get(i);
+        uint32_t calls = st->accepted + st->rejected;
+
+        if (calls == 0) {
+            continue;
+        }
+
+        shell_print(sh, "%-8s  %8u  %8u  %6d  %7u  %7u",
+                    sensor_health_name(i), st->accepted, st->rejected, st->last_median,
+                    (uint32_t)(st->total_cycles / calls), st->max_cycles);
+    }
+
+    return 0;
+}
+
+static int cmd_soil(const struct shell *sh, size_t argc, char **argv)
+{
+    const struct soil_forecast *fc = soil_forecast_get();
+
+    shell_print(sh, "fit points:  %u (%u restarts after watering)", fc->points, fc->resets);
+    shell_print(sh, "moisture:    %d (centi-percent, dry below %d)",
+                fc->moisture, SOIL_DRY_THRESHOLD);
+    shell_print(sh, "slope:       %d per hour", fc->slope_q8 / 256);
+    if (fc->time_to_dry_s < 0) {
+        shell_print(sh, "dry in:      not drying");
+    } else {
+        shell_print(sh, "dry in:      %d min", fc->time_to_dry_s / 60);
+    }
+    shell_print(sh, "interval:    x%u", fc->stretch);
+
+    return 0;
+}
+
+static int cmd_water(const struct shell *sh, size_t argc, char **argv)
+{
+    const struct watering_stats *st = watering_get();
+
+    shell_print(sh, "state:       %s", watering_active() ? "watering" : "idle");
+    shell_print(sh, "events:      %u (%u doses)", st->events, st->doses);
+    shell_print(sh, "pump on:     %u ms total, %u of %u ms today",
+                st->runtime_ms, st->today_ms, WATER_DAILY_CAP_MS);
+    shell_print(sh, "forced off:  %u", st->forced_off);
+
+    return 0;
+}
+
+static int cmd_cache(const struct shell *sh, size_t argc, char **argv)
+{
+    shell_print(sh, "Cached records: %u", data_cache_depth());
+
+    return 0;
+}
+
+static int cmd_mqtt(const struct shell *sh, size_t argc, char **argv)
+{
+    const struct aws_mqtt_stats *st = aws_mqtt_get_stats();
+
+    shell_print(sh, "published:     %u", st->published);
+    shell_print(sh, "errors:        %u", st->publish_errors);
+    shell_print(sh, "pubacks:       %u", st->pubacks);
+    shell_print(sh, "in-flight QoS1: %u", st->inflight);
+    shell_print(sh, "PUBACKs saved: %u", qos_policy_pubacks_saved());
+    shell_print(sh, "connects:      %u", st->connects);
+    shell_print(sh, "disconnects:   %u", st->disconnects);
+    shell_print(sh, "received:      %u", st->received);
+    shell_print(sh, "commands run:  %u", mqtt_commands_count());
+    shell_print(sh, "reconnect attempts: %u", app_get_reconnect_attempts());
+
+    return 0;
+}
+
+static int cmd_link(const struct shell *sh, size_t argc, char **argv)
+{
+    const struct link_policy_decision *d = link_policy_get();
+
+    shell_print(sh, "uplink interval: %u s", d->uplink_interval_ms / 1000U);
+    shell_print(sh, "mode:            %s",
+                d->mode == LINK_MODE_STAY_CONNECTED ? "stay connected" : "disconnect");
+    shell_print(sh, "keepalive:       %u s", d->keepalive_s);
+    shell_print(sh, "stay cost:       %u uJ", d->stay_cost_uj);
+    shell_print(sh, "reconnect cost:  %u uJ", d->reconnect_cost_uj);
+
+    return 0;
+}
+
+static int cmd_rf(const struct shell *sh, size_t argc, char **argv)
+{
+    const struct link_quality_stats *st = link_quality_get();
+    const struct tx_power_state *txp = tx_power_get();
+
+    shell_print(sh, "rssi:            %d dBm", link_quality_rssi());
+    shell_print(sh, "uplink windows:  %u (deferred %u, forced %u)",
+                st->windows, st->deferred, st->forced);
+    shell_print(sh, "retries:         %u (last window %u, %u frames)",
+                st->retries, st->last_retries, st->tx_packets);
+    shell_print(sh, "airtime:         %u ms for %u bytes", st->airtime_ms, st->tx_bytes);
+    shell_print(sh, "us per byte:     %u (last window)", st->last_us_per_byte);
+    shell_print(sh, "tx power:        %d/4 dBm (floor %d/4, %u down, %u up)",
+                txp->level_qdbm, txp->floor_qdbm, txp->steps_down, txp->steps_up);
+    shell_print(sh, "retry rate:      %u per 1000 frames", txp->retry_rate_pm);
+    shell_print(sh, "tx energy saved: %u uJ", txp->saved_uj);
+
+    for (int i = 0; i < LINK_QUALITY_SLOTS; i++) {
+        int rssi = link_quality_slot_rssi(i);
+
+        if (rssi) {
+            shell_print(sh, "  hour %2d: %d dBm", i, rssi);
+        }
+    }
+
+    return 0;
+}
+
+static int cmd_power(const struct shell *sh, size_t argc, char **argv)
+{
+    const struct power_tier_cfg *tier = power_policy_get();
+
+    shell_print(sh, "power tier:        %d", power_policy_tier());
+    shell_print(sh, "interval x%u, batch >= %u", tier->interval_mult, tier->min_batch);
+    shell_print(sh, "BLE advertising:   %s", tier->ble_advertising ? "on" : "off");
+    shell_print(sh, "payload:           %s", tier->full_payload ? "full" : "critical only");
+    shell_print(sh, "charging:          %s (VCELL %+d mV)",
+                charge_monitor_is_charging() ? "yes" : "no", charge_monitor_trend_mv());
+
+    return 0;
+}
+
+static int cmd_interval(const struct shell *sh, size_t argc, char **argv)
+{
+    if (argc > 1) {
+        uint32_t seconds = strtoul(argv[1], NULL, 10);
+
+        // Bounded before scaling so a huge value cannot wrap into range
+        if (seconds > POLLING_INTERVAL_MAX / 1000U ||
+            app_set_polling_interval(seconds * 1000U)) {
+            shell_error(sh, "Invalid interval: %s", argv[1]);
+            return -EINVAL;
+        }
+    }
+
+    shell_print(sh, "Polling interval: %u s", app_get_polling_interval() / 1000U);
+
+    return 0;
+}
+
+static int cmd_batch(const struct shell *sh, size_t argc, char **argv)
+{
+    if (argc > 1) {
+        uint32_t size = strtoul(argv[1], NULL, 10);
+
+        if (size > UINT8_MAX || app_set_batch_size(size)) {
+            shell_error(sh, "Invalid batch size: %s (1-%d)", argv[1], BATCH_SIZE_MAX);
+            return -EINVAL;
+        }
+    }
+
+    shell_print(sh, "Batch size: %u", app_get_batch_size());
+
+    return 0;
+}
+
+static int cmd_ram(const struct shell *sh, size_t argc, char **argv)
+{
+    size_t free_bytes;
+    size_t max_allocated;
+    int ret;
+
+    ret = diagnostics_heap_stats(&free_bytes, &max_allocated);
+    if (ret) {
+        shell_error(sh, "Heap stats unavailable: %d", ret);
+        return ret;
+    }
+
+    shell_print(sh, "heap free:     %u", (uint32_t)free_bytes);
+    shell_print(sh, "heap max used: %u", (uint32_t)max_allocated);
+    shell_print(sh, "bluetooth:     %s", ble_provisioning_is_enabled() ? "on" : "off");
+#if defined(CONFIG_MBEDTLS_SSL_MAX_CONTENT_LEN)
+    shell_print(sh, "tls records:   %u bytes in and out, MFL %s", CONFIG_MBEDTLS_SSL_MAX_CONTENT_LEN,
+                IS_ENABLED(CONFIG_MBEDTLS_SSL_MAX_FRAGMENT_LENGTH) ? "on" : "off");
+#endif
+
+    return 0;
+}
+
+static int cmd_ble(const struct shell *sh, size_t argc, char **argv)
+{
+    int ret;
+
+    if (argc < 2) {
+        const struct ble_coex_stats *coex = ble_provisioning_coex_stats();
+
+        shell_print(sh, "bluetooth:        %s", ble_provisioning_is_enabled() ? "on" : "off");
+        shell_print(sh, "uplink windows:   %u", coex->windows);
+        shell_print(sh, "with connection:  %u", coex->contended);
+        shell_print(sh, "yielded ms:       %u (max %u)", coex->yield_ms, coex->max_yield_ms);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "on") == 0) {
+        ret = ble_provisioning_init();
+    } else if (strcmp(argv[1], "off") == 0) {
+        ret = ble_provisioning_deinit();
+    } else {
+        shell_error(sh, "Expected on or off");
+        return -EINVAL;
+    }
+
+    if (ret) {
+        shell_error(sh, "Failed: %d", ret);
+    }
+
+    return ret;
+}
+
+static int cmd_i2c(const struct shell *sh, size_t argc, char **argv)
+{
+    if (!I2C_TRACE_ENABLED) {
+        shell_warn(sh, "I2C tracer disabled (I2C_TRACE_ENABLED)");
+        return 0;
+    }
+
+    i2c_trace_print(sh);
+
+    return 0;
+}
+
+static int cmd_adc(const struct shell *sh, size_t argc, char **argv)
+{
+    const struct adc_sampler_stats *st = adc_sampler_get_stats();
+
+    shell_print(sh, "bursts: %u  errors: %u", st->bursts, st->errors);
+    shell_print(sh, "last_us: %u  max_us: %u  avg_us: %u", st->last_us, st->max_us,
+                st->bursts ? (uint32_t)(st->total_us / st->bursts) : 0);
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(fg_cmds,
+    SHELL_CMD(sample, NULL, "Run an acquisition cycle now", cmd_sample),
+    SHELL_CMD(stats, NULL, "Per-stage cycle timing", cmd_stats),
+    SHELL_CMD(hist, NULL, "Latency and jitter histograms", cmd_hist),
+    SHELL_CMD(sensors, NULL, "Per-sensor health counters", cmd_sensors),
+    SHELL_CMD(filter, NULL, "Spike rejection counters and cost", cmd_filter),
+    SHELL_CMD(soil, NULL, "Soil drying forecast and sampling stretch", cmd_soil),
+    SHELL_CMD(water, NULL, "Local watering loop and pump interlocks", cmd_water),
+    SHELL_CMD(cache, NULL, "Offline cache depth", cmd_cache),
+    SHELL_CMD(mqtt, NULL, "MQTT in-flight and reconnect counters", cmd_mqtt),
+    SHELL_CMD(link, NULL, "Keepalive vs disconnect decision", cmd_link),
+    SHELL_CMD(rf, NULL, "Wi-Fi RSSI history, retries, airtime and TX power", cmd_rf),
+    SHELL_CMD(power, NULL, "Battery power tier", cmd_power),
+    SHELL_CMD_ARG(interval, NULL, "Show or set polling interval [seconds]", cmd_interval, 1, 1),
+    SHELL_CMD_ARG(batch, NULL, "Show or set batch size [samples]", cmd_batch, 1, 1),
+    SHELL_CMD(ram, NULL, "System heap usage", cmd_ram),
+    SHELL_CMD_ARG(ble, NULL, "BT state and Wi-Fi coexistence, or switch it [on|off]", cmd_ble, 1, 1),
+    SHELL_CMD(i2c, NULL, "I2C per-device bus timing", cmd_i2c),
+    SHELL_CMD(adc, NULL, "ADC conversion timing", cmd_adc),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(fg, &fg_cmds, "Plant monitor runtime inspection", NULL);
@@ -0,0 +1,85 @@
+#ifndef APP_H
+#define APP_H
+
+#include <stdint.h>
+
+// Stages of one acquisition/uplink cycle
+enum app_stage {
+    APP_STAGE_SENSORS,
+    APP_STAGE_PUBLISH,
+    APP_STAGE_CACHE,
+    APP_STAGE_CYCLE,
+    APP_STAGE_COUNT
+};
+
+struct app_stage_stats {
+    uint32_t count;
+    uint32_t last_us;
+    uint32_t max_us;
+    uint64_t total_us;
+};
+
+/**
+ * @brief Run an acquisition cycle immediately and publish it
+ */
+void app_sample_now(void);
+
+/**
+ * @brief Publish immediately and drain the whole offline cache
+ */
+void app_flush_cache(void);
+
+/**
+ * @brief Change the polling interval, effective from the next cycle
+ *
+ * @param interval_ms Interval in milliseconds
+ * @return 0 on success, -EINVAL if out of range
+ */
+int app_set_polling_interval(uint32_t interval_ms);
+
+/**
+ * @brief Get the current polling interval
+ *
+ * @return Interval in milliseconds
+ */
+uint32_t app_get_polling_interval(void);
+
+/**
+ * @brief Change the number of samples published together
+ *
+ * @param size Samples per uplink, 1 to BATCH_SIZE_MAX
+ * @return 0 on success, -EINVAL if out of range
+ */
+int app_set_batch_size(uint8_t size);
+
+/**
+ * @brief Get the number of samples published together
+ *
+ * @return Samples per uplink
+ */
+uint8_t app_get_batch_size(void);
+
+/**
+ * @brief Get the timing counters of a cycle stage
+ *
+ * @param stage Stage identifier
+ * @return Pointer to the stage counters
+ */
+const struct app_stage_stats *app_get_stage_stats(enum app_stage stage);
+
+/**
+ * @brief Get a short printable name for a cycle stage
+ *
+ * @param stage Stage identifier
+ * @return Stage name
+ */
+const char *app_stage_name(enum app_stage stage);
+
+/**
+ * @brief Get the number of consecutive cycles without connectivity
+ *
+ * @return Reconnect attempts since the last successful uplink
+ */
+uint32_t app_get_reconnect_attempts(void);
+
+#endif /* APP_H */
@@ -0,0 +1,39 @@
+#ifndef CACHE_REPLAY_H
+#define CACHE_REPLAY_H
+
+#include <stdint.h>
+
+// Outcome of one cache drain
+struct cache_replay_result {
+    uint32_t sent;            // First transmissions
+    uint32_t acked;
+    uint32_t retries;         // Retransmissions after a PUBACK timeout
+    uint8_t final_window;
+    uint32_t elapsed_ms;
+};
+
+/**
+ * @brief Drain the offline cache with pipelined QoS1 publishes
+ *
+ * Up to max_window messages are kept outstanding. The window grows by one
+ * per PUBACK and halves on every PUBACK timeout. Acknowledged records are
+ * removed from the cache, even when the drain stops early.
+ *
+ * @param topic Null-terminated topic to publish on
+ * @param max_window Maximum outstanding messages, 1 to REPLAY_WINDOW_MAX
+ * @param max_records Records to send in this drain, 0 for no limit
+ * @param result Pointer to store the drain counters, may be NULL
+ * @return 0 if the cache was drained or the record limit reached,
+ *         negative errno otherwise
+ */
+int cache_replay_run(const char *topic, uint8_t max_window, uint32_t max_records,
+                     struct cache_replay_result *result);
+
+/**
+ * @brief Get the total number of replay retransmissions since boot
+ *
+ * @return Retransmission count
+ */
+uint32_t cache_replay_total_retries(void);
+
+#endif /* CACHE_REPLAY_H */
@@ -0,0 +1,30 @@
+#ifndef CHARGE_MONITOR_H
+#define CHARGE_MONITOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Feed a new fuel gauge reading to the trend detector
+ *
+ * @param vcell_mv Cell voltage in millivolts
+ * @param soc State of charge in percent
+ * @return true if the charging state changed
+ */
+bool charge_monitor_update(int32_t vcell_mv, float soc);
+
+/**
+ * @brief Check whether the battery is currently being charged
+ *
+ * @return true while charging
+ */
+bool charge_monitor_is_charging(void);
+
+/**
+ * @brief Get the VCELL change over the trend window
+ *
+ * @return Newest minus oldest cell voltage in millivolts
+ */
+int32_t charge_monitor_trend_mv(void);
+
+#endif /* CHARGE_MONITOR_H */
@@ -12,6 +12,16 @@
 #define AHT10_ADDR         0x38
 #define SOIL_MOISTURE_ADDR 0x36
 #define MAX17043_ADDR      0x36
+#define MAX17043_CACHE_MAX_AGE_MS 1000  // Reuse one VCELL..CONFIG burst within a cycle
+
+// I2C tracer configurations
+#define I2C_TRACE_ENABLED   1  // Account every sensor I2C transfer per address
+#define I2C_TRACE_MAX_ADDRS 8
+
+// Sensor power gating warm-up times (rails are defined in the board overlay)
+#define AHT10_WARMUP_MS    40  // Power-on to first command
+#define SOIL_WARMUP_MS     50  // Capacitive probe oscillator settling
+#define LIGHT_WARMUP_MS    2   // Photoresistor divider RC settling
 
 // Storage configurations
 #define STORAGE_NAMESPACE  "settings"
@@ -19,21 +29,157 @@
 
 // Timing configurations
 #define POLLING_INTERVAL   (60 * 1000) // 1 minute in milliseconds
+#define POLLING_INTERVAL_MIN (5 * 1000)
+#define POLLING_INTERVAL_MAX (24 * 60 * 60 * 1000)
+
+// Uplink batching
+#define BATCH_SIZE_DEFAULT  1    // Samples per uplink
+#define BATCH_SIZE_MAX      8
+#define PAYLOAD_RECORD_MAX  384  // Largest JSON record for one sample
+#define TLS_PUBLISH_OVERHEAD 144 // MQTT fixed header, topic and id sharing a TLS record
+
+// Battery tiers (MAX17043 SOC, percent)
+#define POWER_TIER_SAVER_SOC     50
+#define POWER_TIER_LOW_SOC       25
+#define POWER_TIER_CRITICAL_SOC  10
+#define POWER_TIER_HYSTERESIS    5   // SOC rise needed before leaving a tier
+
+// Charge-aware boost (MAX17043 VCELL/SOC trend)
+#define CHARGE_TREND_SAMPLES       5
+#define CHARGE_START_RISE_MV       20      // VCELL rise over the window that means charging
+#define CHARGE_BOOST_INTERVAL_DIV  4       // Sample this much faster while charging
+
+// Diagnostics configurations
+#define DIAG_EVERY_N_UPLINKS 60  // About hourly at the default polling interval
+#define DIAG_PAYLOAD_MAX     384
+
+// Sensor health configurations
+#define SENSOR_MAX_CONSECUTIVE_FAILURES 5
+#define SENSOR_REPROBE_INTERVAL_MS      (15 * 60 * 1000) // 15 minutes
 
 #define AWS_ENDPOINT "your-endpoint.iot.region.amazonaws.com"
 #define AWS_PORT 8883
 #define AWS_CLIENT_ID "your-client-id"
 #define MQTT_PUBLISH_TOPIC "your/topic/"
+#define AWS_MQTT_BUFFER_SIZE 1024
+#define AWS_MQTT_CONNECT_TIMEOUT_MS 10000
+#define AWS_SEC_TAG 1
+#define AWS_MQTT_RTT_SLOTS 16   // Outstanding QoS1 messages timed for the RTT histogram
+#define AWS_MQTT_RX_PAYLOAD_MAX 256
+#define AWS_MQTT_RX_STACK_SIZE 4096  // TLS records are decrypted on this stack
+#define AWS_MQTT_RX_PRIORITY 7       // Receive thread for kept sessions
+
+// Command channel (<MQTT_PUBLISH_TOPIC><plant_id>/cmd)
+#define COMMAND_PAYLOAD_MAX       128
+#define COMMAND_LISTEN_WINDOW_MS  500   // Stay on after an uplink before disconnecting
+
+// Link policy energy model (stay connected vs disconnect between uplinks)
+#define LINK_KEEPALIVE_MAX_S       1200    // AWS IoT upper limit
+#define LINK_KEEPALIVE_MARGIN_S    30      // Slack for a late uplink
+#define LINK_DTIM_PERIOD_MS        307     // DTIM3 at 102.4 ms beacons
+#define LINK_ENERGY_DTIM_UJ        500     // One beacon listen
+#define LINK_ENERGY_PING_UJ        8000    // PINGREQ/PINGRESP exchange
+#define LINK_ENERGY_RECONNECT_UJ   250000  // Association, resumed TLS, CONNECT
+
+// RSSI-aware uplink scheduling
+#define LINK_RSSI_DEFER_DBM        (-75)   // Hold non-urgent batches below this
+#define LINK_RSSI_BETTER_DB        6       // Historic gain worth waiting for
+#define UPLINK_MAX_LATENCY_MS      (30 * 60 * 1000)  // Oldest sample never waits longer
+
+// Adaptive Wi-Fi TX power (0.25 dBm steps, the esp_wifi_set_max_tx_power unit)
+#define TX_POWER_MAX_QDBM          80      // 20 dBm
+#define TX_POWER_MIN_QDBM          8       // 2 dBm
+#define TX_POWER_STEP_QDBM         8       // 2 dB per uplink window
+#define TX_POWER_HEADROOM_DBM      (-60)   // Only step down above this RSSI
+#define TX_POWER_RSSI_FLOOR_DBM    (-72)   // Step back up below this RSSI
+#define TX_POWER_RETRY_LOW_PM      20      // Retries per 1000 frames still clean
+#define TX_POWER_RETRY_HIGH_PM     100     // Retries per 1000 frames that mean too low
+#define TX_POWER_FLOOR_RELAX_WINDOWS 50    // Clean windows before retrying below the floor
+#define TX_POWER_UW_PER_QDBM       7500    // PA draw per 0.25 dB, about 30 mW/dB
+#define TX_POWER_TX_DUTY_PCT       20      // Share of an uplink window spent transmitting
+
+// Offline cache replay
+#define REPLAY_WINDOW_DEFAULT  4     // Outstanding QoS1 messages while draining
+#define REPLAY_WINDOW_MAX      16
+#define REPLAY_ACK_TIMEOUT_MS  3000
+#define REPLAY_MAX_RETRIES     3
+#define REPLAY_POLL_MS         100
+#define REPLAY_MAX_RECORDS_PER_UPLINK 50  // Bound radio time outside charge windows
+
+// Benchmarks (shell 'bench' command, against a local broker stand-in)
+#define APP_BENCH_ENABLED      0
+#define BENCH_TOPIC            "bench/fgdev"
+#define BENCH_REPLAY_RECORDS   200
+#define BENCH_TLS_ROUNDS       5
+#define BENCH_ACTIVE_MW        330   // CPU and radio during a handshake, for energy per connect
+
+// Simulation (native_sim scenario runner, see sim/)
+#define SIM_DURATION_S        (24 * 60 * 60)
+#define SIM_STEP_S            10       // Scenario update period
+#define SIM_DEADLINE_SLACK_MS 1000     // Later publish_work starts count as missed
+#define SIM_BATTERY_UJ        (200ULL * 1000 * 1000)  // Small cell so tiers show within a day
+#define SIM_START_SOC         55
+#define SIM_SLEEP_UW          60
+#define SIM_CHARGE_UW         20000
+#define SIM_SAMPLE_UJ         3000     // Rails, conversions and I2C for one acquisition
+#define SIM_PUBLISH_UJ        2000     // Per MQTT PUBLISH on an established session
+#define SIM_TX_UJ_PER_BYTE    2
+#define SIM_BROKER_RTT_MS     40
 
 // ADC configurations
 #define ADC_RESOLUTION 12
-#define ADC_GAIN ADC_GAIN_1
+#define ADC_GAIN ADC_GAIN_1_4         // ESP32 11/12 dB attenuation, ~3.1 V full scale
 #define ADC_REFERENCE ADC_REF_INTERNAL
 #define ADC_ACQUISITION_TIME ADC_ACQ_TIME_DEFAULT
-#define ADC_CHANNEL 0
+#define ADC_OVERSAMPLING 0           // Not implemented by adc_esp32; the burst median filters noise
+#define ADC_BURST_SAMPLES 5          // Conversions per input, median reported
+#define ADC_CHANNEL_LIGHT 0          // Photoresistor divider
+#define ADC_CHANNEL_SOIL 1           // Analog capacitive soil probe
+#define ADC_CHANNEL_BATTERY 2        // Battery divider (MAX17043 cross-check)
+
+// ADC calibration (pin millivolts)
+#define LIGHT_ADC_DARK_MV 0
+#define LIGHT_ADC_BRIGHT_MV 3000      // Divider near the rail, below where the ADC clips
+#define SOIL_ADC_DRY_MV 2800         // Probe output in air
+#define SOIL_ADC_WET_MV 1200         // Probe output in water
+#define BATTERY_DIVIDER_RATIO 2      // Cell voltage / pin voltage
+#define BATTERY_CROSSCHECK_MV 150    // Max divider vs MAX17043 VCELL disagreement
+#define SOIL_PROBE_ANALOG 1          // 1: soil from the ADC probe, 0: I2C sensor
+
+// Spike rejection against the rolling median (centi-percent)
+#define FILTER_WINDOW 5
+#define FILTER_SOIL_SPIKE 1500       // 15 % moisture between samples
+#define FILTER_LIGHT_SPIKE 3000
+#define FILTER_MAX_REJECTS 3         // Spikes in a row accepted as a real change
+
+// Soil drying forecast (centi-percent)
+#define SOIL_DRY_THRESHOLD 3000      // Plant needs water below 30 %
+#define SOIL_FORECAST_WINDOW 8       // Readings in the least-squares fit
+#define SOIL_FORECAST_MIN_POINTS 4
+#define SOIL_FORECAST_SAMPLES_TO_DRY 6   // Readings wanted before the predicted crossing
+#define SOIL_FORECAST_MAX_STRETCH 8  // Longest interval, in polling intervals
+#define SOIL_FORECAST_RESET_RISE 500 // Rise that means the plant was watered
+
+// Local watering (pump-gpios in the zephyr,user node, centi-percent)
+#define WATERING_ENABLED 1           // Still needs a pump-gpios property
+#define WATER_ON_THRESHOLD SOIL_DRY_THRESHOLD
+#define WATER_OFF_THRESHOLD 4500     // Dose until the soil is back above this
+#define WATER_DOSE_MS 5000
+#define WATER_MAX_RUNTIME_MS 15000   // Interlock: longest single pump run
+#define WATER_DAILY_CAP_MS 60000     // Interlock: pump on-time per 24 h of uptime, kept across reboots
+#define WATER_MAX_DOSES 3            // Per event before reporting no rise
+#define WATER_SOAK_MS (2 * 60 * 1000)    // Let the dose reach the probe
+#define WATER_RESAMPLE_MS 10000      // Polling interval while the water soaks in
+#define WATER_DOSE_RESAMPLE_MS 2500  // Polling interval while the pump runs, <= WATER_DOSE_MS
 #define BUTTON_DEBOUNCE_TIME K_MSEC(100)
 #define CONFIG_BT_DEVICE_NAME "FGDev"
-#define CACHE_FILE_PATH "/lfs/cache.json"
+#define BLE_TEARDOWN_AFTER_UPLINK 1  // Disable BT once provisioned (fg ble on to re-provision)
+#define COEX_YIELD_CONN_INTERVAL 320  // 400 ms BLE connection interval during uplinks
+#define COEX_YIELD_CONN_TIMEOUT  600  // 6 s supervision timeout (10 ms units)
+#define CACHE_DIR "/lfs/cache"               // Numbered segments of struct plant_sample records
+#define CACHE_SEGMENT_RECORDS 256            // Records per segment file (4 KB)
+#define CACHE_FILE_PATH "/lfs/cache.bin"     // Flat file of earlier firmware, migrated at boot
+#define CACHE_LEGACY_FILE_PATH "/lfs/cache.json"
 #define CONFIG_APP_VERSION "1.0.0"  // Add version number
 
 #endif /* CONFIG_H */
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef DATA_CACHE_H
+#define DATA_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/fs/fs.h>
+#include "plant_data.h"
+
+/**
+ * @brief Count the records already present in the offline cache
+ *
+ * The cache is a series of numbered segment files of struct plant_sample
+ * records in CACHE_DIR, plus the persisted read position in the oldest one.
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int data_cache_init(void);
+
+/**
+ * @brief Append samples to the offline cache
+ *
+ * @param samples Samples to store
+ * @param count Number of samples
+ * @return 0 on success, negative errno on failure
+ */
+int data_cache_append(const struct plant_sample *samples, size_t count);
+
+/**
+ * @brief Read the record starting at a given offset
+ *
+ * Offsets count from the oldest record not yet discarded.
+ *
+ * @param offset Offset of the record, advanced past it on success
+ * @param sample Pointer to store the sample
+ * @return Record length, 0 at the end of the cache, negative errno on failure
+ */
+int data_cache_read(off_t *offset, struct plant_sample *sample);
+
+/**
+ * @brief Drop every record before an offset
+ *
+ * Fully acknowledged segments are deleted; nothing is copied. A reset before
+ * the new position is saved sends the oldest segment's records again.
+ *
+ * @param offset Offset of the first record to keep, as for data_cache_read()
+ * @return 0 on success, negative errno on failure
+ */
+int data_cache_discard(off_t offset);
+
+/**
+ * @brief Get the number of records waiting in the offline cache
+ *
+ * @return Number of cached records
+ */
+uint32_t data_cache_depth(void);
+
+#endif /* DATA_CACHE_H */
@@ -0,0 +1,44 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Update the persistent boot count and latch the reset reason
+ *
+ * Must be called after settings_load().
+ */
+void diagnostics_init(void);
+
+/**
+ * @brief Account for one telemetry uplink
+ *
+ * @return true if a diagnostics record should ride along with this uplink
+ */
+bool diagnostics_uplink_tick(void);
+
+/**
+ * @brief Get the system heap usage
+ *
+ * Only the Zephyr system heap is covered. Whether the Wi-Fi driver, the BT
+ * controller and mbedTLS allocate from it depends on the port and on
+ * CONFIG_MBEDTLS_ENABLE_HEAP.
+ *
+ * @param free_bytes Bytes currently free
+ * @param max_allocated High-watermark of allocated bytes
+ * @return 0 on success, -ENOTSUP without heap runtime stats
+ */
+int diagnostics_heap_stats(size_t *free_bytes, size_t *max_allocated);
+
+/**
+ * @brief Format the compact diagnostics record
+ *
+ * @param buf Output buffer
+ * @param size Size of the output buffer
+ * @return Length of the record, negative errno on failure
+ */
+int diagnostics_format(char *buf, size_t size);
+
+#endif /* DIAGNOSTICS_H */
@@ -0,0 +1,62 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HISTOGRAM_BUCKETS 16
+
+// Latency distributions tracked in production
+enum hist_id {
+    HIST_PUBLISH_RTT,         // QoS1 publish to PUBACK
+    HIST_WORK_JITTER,         // publish_work start vs scheduled time
+    HIST_SENSOR_READ,         // Single sensor read
+    HIST_COUNT
+};
+
+struct histogram_snapshot {
+    uint32_t buckets[HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+    uint8_t shift;            // Bucket b>0 holds [2^(b-1), 2^b) << shift us
+};
+
+/**
+ * @brief Add a sample to a histogram
+ *
+ * Constant time: one count-leading-zeros and two atomic increments.
+ *
+ * @param id Histogram identifier
+ * @param value_us Sample in microseconds
+ */
+void histogram_record(enum hist_id id, uint32_t value_us);
+
+/**
+ * @brief Copy a histogram
+ *
+ * @param id Histogram identifier
+ * @param snap Pointer to store the copy
+ */
+void histogram_get(enum hist_id id, struct histogram_snapshot *snap);
+
+/**
+ * @brief Get a short printable name for a histogram
+ *
+ * @param id Histogram identifier
+ * @return Histogram name
+ */
+const char *histogram_name(enum hist_id id);
+
+/**
+ * @brief Encode a histogram as a compact JSON array
+ *
+ * Only the span of non-empty buckets is written, as [first, n0, n1, ...].
+ *
+ * @param id Histogram identifier
+ * @param buf Output buffer
+ * @param size Size of the output buffer
+ * @return Length written, negative errno on failure
+ */
+int histogram_format(enum hist_id id, char *buf, size_t size);
+
+#endif /* HISTOGRAM_H */
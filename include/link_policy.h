@@ -0,0 +1,36 @@
+#ifndef LINK_POLICY_H
+#define LINK_POLICY_H
+
+#include <stdint.h>
+
+// What to do with the broker session between uplinks
+enum link_mode {
+    LINK_MODE_STAY_CONNECTED,
+    LINK_MODE_DISCONNECT,
+};
+
+struct link_policy_decision {
+    enum link_mode mode;
+    uint16_t keepalive_s;
+    uint32_t uplink_interval_ms;
+    uint32_t stay_cost_uj;        // Pings plus DTIM wakeups over one interval
+    uint32_t reconnect_cost_uj;   // Association, resumed TLS and CONNECT
+};
+
+/**
+ * @brief Re-evaluate the link policy for a new uplink interval
+ *
+ * Also pushes the chosen keepalive to the MQTT client.
+ *
+ * @param uplink_interval_ms Time between uplinks in milliseconds
+ */
+void link_policy_update(uint32_t uplink_interval_ms);
+
+/**
+ * @brief Get the current link policy decision
+ *
+ * @return Pointer to the decision
+ */
+const struct link_policy_decision *link_policy_get(void);
+
+#endif /* LINK_POLICY_H */
@@ -0,0 +1,73 @@
+#ifndef LINK_QUALITY_H
+#define LINK_QUALITY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LINK_QUALITY_SLOTS 24     // One RSSI history slot per hour of uptime
+
+// Radio link counters
+struct link_quality_stats {
+    int8_t rssi;                  // Last reading in dBm, 0 if not associated
+    uint32_t windows;             // Uplink windows measured
+    uint32_t deferred;            // Uplinks put off for a weak signal
+    uint32_t forced;              // Weak-signal uplinks sent at the latency bound
+    uint32_t retries;             // Wi-Fi TX failures plus MQTT retransmissions
+    uint32_t tx_packets;          // Wi-Fi frames sent, 0 without Wi-Fi statistics
+    uint32_t tx_bytes;            // MQTT payload bytes sent in uplink windows
+    uint32_t airtime_ms;          // Time spent publishing, all uplink windows
+    uint32_t last_retries;
+    uint32_t last_tx_packets;
+    uint32_t last_airtime_ms;
+    uint32_t last_us_per_byte;    // Publish time per payload byte, last window
+};
+
+/**
+ * @brief Read the RSSI of the current association
+ *
+ * @return RSSI in dBm, 0 if not associated or unavailable
+ */
+int link_quality_rssi(void);
+
+/**
+ * @brief Decide whether a non-urgent uplink should wait for a better signal
+ *
+ * Reads the RSSI and folds it into the history of the current hour slot.
+ * Below LINK_RSSI_DEFER_DBM the uplink is deferred only if a slot seen
+ * before, and due within the latency bound, was LINK_RSSI_BETTER_DB better.
+ *
+ * @param oldest_age_ms Age of the oldest unsent sample
+ * @param next_interval_ms Time until the next chance to send
+ * @return true to keep the batch for a later uplink
+ */
+bool link_quality_defer_uplink(uint32_t oldest_age_ms, uint32_t next_interval_ms);
+
+/**
+ * @brief Mark the start of the publish phase of an uplink window
+ */
+void link_quality_uplink_begin(void);
+
+/**
+ * @brief Mark the end of the publish phase and account its retries and airtime
+ *
+ * Call before any listen window or disconnect, so airtime is the time spent
+ * publishing rather than the whole time the link was up.
+ */
+void link_quality_uplink_end(void);
+
+/**
+ * @brief Get the mean RSSI history of an hour slot
+ *
+ * @param slot Hour slot, 0 to LINK_QUALITY_SLOTS - 1
+ * @return Mean RSSI in dBm, 0 if the slot has no readings yet
+ */
+int link_quality_slot_rssi(int slot);
+
+/**
+ * @brief Get the radio link counters
+ *
+ * @return Pointer to the counters
+ */
+const struct link_quality_stats *link_quality_get(void);
+
+#endif /* LINK_QUALITY_H */
@@ -0,0 +1,58 @@
+#ifndef PLANT_DATA_H
+#define PLANT_DATA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/toolchain.h>
+
+// Per-device description, loaded once from settings
+struct plant_meta {
+    char plant_id[37];        // UUID v4 string
+    char plant_name[50];
+    char plant_variety[50];
+    char plant_location[100];
+};
+
+// One acquisition in fixed point; batches, the replay window and the
+// offline cache hold only these
+struct plant_sample {
+    uint32_t timestamp;       // Uptime in seconds
+    int16_t temperature;      // Centi-degrees Celsius
+    uint16_t humidity;        // Centi-percent
+    uint16_t soil_moisture;   // Centi-percent
+    uint16_t light_level;     // Centi-percent
+    uint16_t battery_mv;      // Cell voltage from the ADC divider
+    uint8_t battery_level;    // MAX17043 state of charge, percent
+    uint8_t valid;            // BIT(enum sensor_id) set for each valid reading
+} __packed;
+
+BUILD_ASSERT(sizeof(struct plant_sample) == 16, "plant_sample must stay 16 bytes");
+
+/**
+ * @brief Generate and store the plant UUID on first boot
+ *
+ * Must be called after settings_load().
+ */
+void plant_meta_init(void);
+
+/**
+ * @brief Get the per-device description
+ *
+ * @return Pointer to the metadata record
+ */
+const struct plant_meta *plant_meta_get(void);
+
+/**
+ * @brief Format one sample as a JSON record
+ *
+ * Readings from sensors that failed or are disabled are reported as null.
+ * The descriptive fields are left out when the power tier drops them.
+ *
+ * @param sample Sample to format
+ * @param buf Output buffer
+ * @param size Size of the output buffer
+ * @return Length of the record, negative errno on failure
+ */
+int plant_data_format(const struct plant_sample *sample, char *buf, size_t size);
+
+#endif /* PLANT_DATA_H */
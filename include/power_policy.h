@@ -0,0 +1,47 @@
+#ifndef POWER_POLICY_H
+#define POWER_POLICY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Battery tiers, from full service down to survival mode
+enum power_tier {
+    POWER_TIER_NORMAL,
+    POWER_TIER_SAVER,
+    POWER_TIER_LOW,
+    POWER_TIER_CRITICAL,
+    POWER_TIER_COUNT
+};
+
+// What a tier allows
+struct power_tier_cfg {
+    uint8_t min_soc;          // Enter this tier below the previous tier's min_soc
+    uint8_t interval_mult;    // Polling interval multiplier
+    uint8_t min_batch;        // Smallest batch size allowed
+    bool ble_advertising;
+    bool full_payload;        // false: only critical fields are reported
+};
+
+/**
+ * @brief Feed a new state-of-charge reading to the policy
+ *
+ * @param soc Battery state of charge in percent
+ * @return true if the active tier changed
+ */
+bool power_policy_update(float soc);
+
+/**
+ * @brief Get the active tier
+ *
+ * @return Active tier
+ */
+enum power_tier power_policy_tier(void);
+
+/**
+ * @brief Get the settings of the active tier
+ *
+ * @return Pointer to the tier settings
+ */
+const struct power_tier_cfg *power_policy_get(void);
+
+#endif /* POWER_POLICY_H */
@@ -0,0 +1,45 @@
+#ifndef QOS_POLICY_H
+#define QOS_POLICY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Message classes, each mapped to a QoS level by the policy
+enum msg_class {
+    MSG_CLASS_TELEMETRY,      // Live single sample, superseded by the next one
+    MSG_CLASS_AGGREGATE,      // Batch of several samples
+    MSG_CLASS_REPLAY,         // Records drained from the offline cache
+    MSG_CLASS_ALERT,          // Events that must not be lost
+    MSG_CLASS_DIAG,           // Periodic diagnostics
+    MSG_CLASS_CONTROL,        // Requests to the cloud
+    MSG_CLASS_COUNT
+};
+
+/**
+ * @brief Get the QoS level used for a message class
+ *
+ * @param cls Message class
+ * @return MQTT QoS level (enum mqtt_qos)
+ */
+uint8_t qos_policy_select(enum msg_class cls);
+
+/**
+ * @brief Publish a message with the QoS level of its class
+ *
+ * @param cls Message class
+ * @param topic Null-terminated topic
+ * @param payload Message payload
+ * @param len Payload length
+ * @return 0 on success, negative errno on failure
+ */
+int qos_policy_publish(enum msg_class cls, const char *topic,
+                       const uint8_t *payload, size_t len);
+
+/**
+ * @brief Get the number of PUBACK round trips avoided by QoS0 publishes
+ *
+ * @return Number of messages sent with QoS0
+ */
+uint32_t qos_policy_pubacks_saved(void);
+
+#endif /* QOS_POLICY_H */
@@ -0,0 +1,49 @@
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#include <stdint.h>
+#include "sensor_health.h"
+
+// Per-sensor spike rejection counters
+struct sensor_filter_stats {
+    uint32_t accepted;
+    uint32_t rejected;
+    int32_t last_median;
+    uint32_t max_cycles;      // Cost of one sensor_filter_apply() call
+    uint64_t total_cycles;
+};
+
+/**
+ * @brief Median of a short integer array
+ *
+ * Sorts the array in place; meant for bursts of a few samples.
+ *
+ * @param values Samples
+ * @param count Number of samples (at least 1)
+ * @return Median sample
+ */
+int32_t sensor_filter_median(int32_t *values, int count);
+
+/**
+ * @brief Check a reading against the rolling median of recent readings
+ *
+ * A reading further than the sensor's bound from the median is rejected,
+ * unless FILTER_MAX_REJECTS readings in a row agree on the new level, each
+ * within the bound of the first of them (for example right after watering).
+ * Sensors without a bound always pass.
+ *
+ * @param id Sensor identifier
+ * @param value Reading in the sensor's integer unit
+ * @return 0 if accepted, -ERANGE if rejected as a spike
+ */
+int sensor_filter_apply(enum sensor_id id, int32_t value);
+
+/**
+ * @brief Get the spike rejection counters of a sensor
+ *
+ * @param id Sensor identifier
+ * @return Pointer to the counters
+ */
+const struct sensor_filter_stats *sensor_filter_get(enum sensor_id id);
+
+#endif /* SENSOR_FILTER_H */
@@ -0,0 +1,65 @@
+#ifndef SENSOR_HEALTH_H
+#define SENSOR_HEALTH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sensors tracked by the health monitor
+enum sensor_id {
+    SENSOR_AHT10,
+    SENSOR_SOIL,
+    SENSOR_LIGHT,
+    SENSOR_BATTERY,
+    SENSOR_BATTERY_DIVIDER,
+    SENSOR_COUNT
+};
+
+// Per-sensor health counters
+struct sensor_health {
+    uint32_t successes;
+    uint32_t failures;
+    uint16_t consecutive_failures;
+    bool disabled;
+    uint32_t last_latency_us;
+    uint32_t max_latency_us;
+    uint64_t total_latency_us;
+    int64_t next_probe_ms;    // uptime of the next re-probe while disabled
+};
+
+/**
+ * @brief Check whether a sensor should be read this cycle
+ *
+ * Returns false while a sensor is auto-disabled, except when its re-probe
+ * time has been reached.
+ *
+ * @param id Sensor identifier
+ * @return true if the sensor should be read
+ */
+bool sensor_health_should_read(enum sensor_id id);
+
+/**
+ * @brief Record the outcome of a sensor read
+ *
+ * @param id Sensor identifier
+ * @param result Return value of the driver read (0 on success)
+ * @param start_cycles k_cycle_get_32() value taken before the read
+ */
+void sensor_health_record(enum sensor_id id, int result, uint32_t start_cycles);
+
+/**
+ * @brief Get the health counters of a sensor
+ *
+ * @param id Sensor identifier
+ * @return Pointer to the sensor's counters
+ */
+const struct sensor_health *sensor_health_get(enum sensor_id id);
+
+/**
+ * @brief Get a short printable name for a sensor
+ *
+ * @param id Sensor identifier
+ * @return Sensor name
+ */
+const char *sensor_health_name(enum sensor_id id);
+
+#endif /* SENSOR_HEALTH_H */
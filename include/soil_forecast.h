@@ -0,0 +1,45 @@
+#ifndef SOIL_FORECAST_H
+#define SOIL_FORECAST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Drying trend from the least-squares line over recent soil readings
+struct soil_forecast {
+    uint8_t points;           // Readings in the fit window
+    int32_t slope_q8;         // Centi-percent per hour, 8 fractional bits
+    int32_t moisture;         // Fitted moisture at the newest reading (centi-percent)
+    int32_t time_to_dry_s;    // Until SOIL_DRY_THRESHOLD is crossed, -1 if not drying
+    uint8_t stretch;          // Polling interval multiplier
+    uint32_t resets;          // Fits restarted by a watering
+};
+
+/**
+ * @brief Add a soil reading and refit the drying trend
+ *
+ * The sampling interval is stretched while the dry threshold is far away and
+ * tightened so that about SOIL_FORECAST_SAMPLES_TO_DRY readings land before
+ * the predicted crossing.
+ *
+ * @param timestamp_s Reading time in seconds
+ * @param moisture Soil moisture in centi-percent
+ * @param base_interval_ms Unstretched polling interval
+ * @return true if the interval multiplier changed
+ */
+bool soil_forecast_update(uint32_t timestamp_s, int32_t moisture, uint32_t base_interval_ms);
+
+/**
+ * @brief Get the polling interval multiplier from the forecast
+ *
+ * @return 1 near or below the dry threshold, up to SOIL_FORECAST_MAX_STRETCH
+ */
+uint8_t soil_forecast_stretch(void);
+
+/**
+ * @brief Get the current forecast
+ *
+ * @return Pointer to the forecast
+ */
+const struct soil_forecast *soil_forecast_get(void);
+
+#endif /* SOIL_FORECAST_H */
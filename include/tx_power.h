@@ -0,0 +1,42 @@
+#ifndef TX_POWER_H
+#define TX_POWER_H
+
+#include <stdint.h>
+
+// Closed-loop Wi-Fi TX power state
+struct tx_power_state {
+    int8_t level_qdbm;            // Current limit in 0.25 dBm steps
+    int8_t floor_qdbm;            // Lowest level without excess retries
+    uint16_t retry_rate_pm;       // Retries per thousand frames, last window
+    uint32_t steps_down;
+    uint32_t steps_up;
+    uint32_t saved_uj;            // Estimated PA energy saved versus full power
+};
+
+/**
+ * @brief Apply the current TX power limit to the Wi-Fi driver
+ *
+ * Call before each uplink; the driver only accepts the limit once Wi-Fi is
+ * started, and only changed limits are pushed again.
+ *
+ * @return 0 on success, -ENOTSUP without a driver hook
+ */
+int tx_power_apply(void);
+
+/**
+ * @brief Adjust the TX power after an uplink window
+ *
+ * Steps down one TX_POWER_STEP_QDBM while the RSSI has headroom and the retry
+ * rate stays low, steps back up quickly when retries rise or the signal gets
+ * weak. Changed levels are saved to settings.
+ */
+void tx_power_update(void);
+
+/**
+ * @brief Get the TX power control state
+ *
+ * @return Pointer to the state
+ */
+const struct tx_power_state *tx_power_get(void);
+
+#endif /* TX_POWER_H */
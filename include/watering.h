@@ -0,0 +1,98 @@
+#ifndef WATERING_H
+#define WATERING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// How a watering event ended
+enum watering_result {
+    WATERING_DONE,            // Soil back above WATER_OFF_THRESHOLD
+    WATERING_NO_RISE,         // WATER_MAX_DOSES without reaching it (empty reservoir?)
+    WATERING_CAPPED,          // Daily pump budget used up
+    WATERING_NO_READING,      // Soil probe failed after a dose
+};
+
+struct watering_event {
+    uint32_t timestamp;       // Start, seconds of uptime
+    uint32_t runtime_ms;      // Total pump on-time
+    uint8_t doses;
+    int32_t moisture_start;   // Centi-percent
+    int32_t moisture_end;
+    enum watering_result result;
+};
+
+struct watering_stats {
+    uint32_t events;
+    uint32_t doses;
+    uint32_t runtime_ms;      // All-time pump on-time
+    uint32_t today_ms;        // Pump on-time in the current budget day, kept across reboots
+    uint32_t forced_off;      // Runs stopped by the runtime interlock
+};
+
+/**
+ * @brief Configure the pump GPIO (off)
+ *
+ * Local watering is disabled when the zephyr,user node has no pump-gpios.
+ *
+ * @return 0 on success or without a pump, negative errno on failure
+ */
+int watering_init(void);
+
+/**
+ * @brief Run the control loop on a new soil reading
+ *
+ * Starts a bounded dose below WATER_ON_THRESHOLD and keeps dosing after each
+ * soak until the soil is above WATER_OFF_THRESHOLD, within the per-run and
+ * daily interlocks. Must run on the system workqueue.
+ *
+ * @param moisture Soil moisture in centi-percent
+ * @param valid false if the reading failed or was rejected
+ * @return true if the loop became active or idle (sampling rate changes)
+ */
+bool watering_update(int32_t moisture, bool valid);
+
+/**
+ * @brief Check whether a watering event is in progress
+ *
+ * @return true from the first dose until the event finishes
+ */
+bool watering_active(void);
+
+/**
+ * @brief Get the sampling interval the control loop needs
+ *
+ * @return WATER_DOSE_RESAMPLE_MS while dosing, WATER_RESAMPLE_MS while
+ *         soaking, 0 when idle
+ */
+uint32_t watering_resample_ms(void);
+
+/**
+ * @brief Take the last finished event for reporting
+ *
+ * @param ev Filled with the event
+ * @return true if there was an unreported event
+ */
+bool watering_take_event(struct watering_event *ev);
+
+/**
+ * @brief Put an event back after a failed report
+ *
+ * @param ev Event from watering_take_event()
+ */
+void watering_return_event(const struct watering_event *ev);
+
+/**
+ * @brief Check whether a finished event is waiting to be reported
+ *
+ * @return true if an event is pending
+ */
+bool watering_event_pending(void);
+
+/**
+ * @brief Get the watering counters
+ *
+ * @return Pointer to the counters
+ */
+const struct watering_stats *watering_get(void);
+
+#endif /* WATERING_H */
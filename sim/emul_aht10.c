@@ -0,0 +1,53 @@
+#define DT_DRV_COMPAT sim_aht10
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include "sim.h"
+
+#define AHT10_STATUS_CALIBRATED BIT(3)
+
+// Answers every read with a finished measurement of the scripted environment
+static int aht10_emul_transfer(const struct emul *target, struct i2c_msg *msgs,
+                               int num_msgs, int addr)
+{
+    const struct sim_state *st = sim_state_get();
+    uint32_t raw_h = (uint64_t)st->humidity * 1048576 / 10000;
+    uint32_t raw_t = (uint64_t)(st->temperature + 5000) * 1048576 / 20000;
+
+    for (int i = 0; i < num_msgs; i++) {
+        uint8_t *buf = msgs[i].buf;
+
+        // Init and measure commands need no emulated state
+        if (!(msgs[i].flags & I2C_MSG_READ)) {
+            continue;
+        }
+        if (msgs[i].len < 6) {
+            return -EIO;
+        }
+
+        buf[0] = AHT10_STATUS_CALIBRATED;
+        buf[1] = raw_h >> 12;
+        buf[2] = raw_h >> 4;
+        buf[3] = ((raw_h & 0x0F) << 4) | ((raw_t >> 16) & 0x0F);
+        buf[4] = raw_t >> 8;
+        buf[5] = raw_t;
+    }
+
+    return 0;
+}
+
+static const struct i2c_emul_api aht10_emul_api = {
+    .transfer = aht10_emul_transfer,
+};
+
+static int aht10_emul_init(const struct emul *target, const struct device *parent)
+{
+    return 0;
+}
+
+#define AHT10_EMUL(n) \
+    EMUL_DT_INST_DEFINE(n, aht10_emul_init, NULL, NULL, &aht10_emul_api, NULL)
+
+DT_INST_FOREACH_STATUS_OKAY(AHT10_EMUL)
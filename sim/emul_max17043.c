@@ -0,0 +1,78 @@
+#define DT_DRV_COMPAT sim_max17043
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include "max17043_driver.h"
+#include "sim.h"
+
+// 16-bit big-endian registers addressed by their first byte
+struct max17043_emul_data {
+    uint8_t regs[MAX17043_REG_CONFIG + 2];
+    uint8_t pointer;
+};
+
+static void put_reg(struct max17043_emul_data *data, uint8_t reg, uint16_t value)
+{
+    data->regs[reg] = value >> 8;
+    data->regs[reg + 1] = value & 0xFF;
+}
+
+static int max17043_emul_transfer(const struct emul *target, struct i2c_msg *msgs,
+                                  int num_msgs, int addr)
+{
+    struct max17043_emul_data *data = target->data;
+    const struct sim_state *st = sim_state_get();
+
+    // VCELL is 12 bits of 1.25 mV, SOC is percent plus 1/256ths
+    put_reg(data, MAX17043_REG_VCELL, (st->vcell_mv * 4 / 5) << 4);
+    put_reg(data, MAX17043_REG_SOC, ((st->soc / 100) << 8) | ((st->soc % 100) * 256 / 100));
+
+    for (int i = 0; i < num_msgs; i++) {
+        struct i2c_msg *msg = &msgs[i];
+
+        if (msg->flags & I2C_MSG_READ) {
+            // The register pointer auto-increments across the burst
+            for (uint32_t n = 0; n < msg->len; n++, data->pointer++) {
+                msg->buf[n] = data->pointer < sizeof(data->regs) ? data->regs[data->pointer] : 0;
+            }
+            continue;
+        }
+
+        if (msg->len < 1) {
+            return -EIO;
+        }
+        data->pointer = msg->buf[0];
+
+        // Register writes (MODE, CONFIG); COMMAND and out-of-map writes are dropped
+        for (uint32_t n = 1; n < msg->len; n++, data->pointer++) {
+            if (data->pointer < sizeof(data->regs)) {
+                data->regs[data->pointer] = msg->buf[n];
+            }
+        }
+    }
+
+    return 0;
+}
+
+static const struct i2c_emul_api max17043_emul_api = {
+    .transfer = max17043_emul_transfer,
+};
+
+static int max17043_emul_init(const struct emul *target, const struct device *parent)
+{
+    struct max17043_emul_data *data = target->data;
+
+    put_reg(data, MAX17043_REG_VERSION, 0x0003);
+    put_reg(data, MAX17043_REG_CONFIG, 0x971C);
+
+    return 0;
+}
+
+#define MAX17043_EMUL(n)                                                  \
+    static struct max17043_emul_data max17043_emul_data_##n;              \
+    EMUL_DT_INST_DEFINE(n, max17043_emul_init, &max17043_emul_data_##n,   \
+                        NULL, &max17043_emul_api, NULL)
+
+DT_INST_FOREACH_STATUS_OKAY(MAX17043_EMUL)
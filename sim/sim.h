@@ -0,0 +1,48 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Accelerated-time scenario runner for native_sim. The application runs
+ * unmodified on simulated time; the scenario drives the sensor emulators,
+ * Wi-Fi availability and the battery, and reports at the end of the day.
+ */
+
+// Environment and battery at the current simulated time
+struct sim_state {
+    int32_t temperature;      // Centi-degrees Celsius
+    int32_t humidity;         // Centi-percent
+    int32_t soil_moisture;    // Centi-percent
+    int32_t light_level;      // Centi-percent
+    int32_t soc;              // Centi-percent
+    int32_t vcell_mv;
+    bool wifi_up;
+    bool charging;
+};
+
+// Energy accounting categories for the report
+enum sim_energy {
+    SIM_ENERGY_RADIO,
+    SIM_ENERGY_SENSORS,
+    SIM_ENERGY_SLEEP,
+    SIM_ENERGY_COUNT
+};
+
+/**
+ * @brief Get the scripted state for the current simulated time
+ *
+ * @return Pointer to the state
+ */
+const struct sim_state *sim_state_get(void);
+
+/**
+ * @brief Charge energy spent by the device to the simulated battery
+ *
+ * @param type What the energy was spent on
+ * @param uj Energy in microjoules
+ */
+void sim_energy_add(enum sim_energy type, uint32_t uj);
+
+#endif /* SIM_H */
@@ -0,0 +1,35 @@
+#include <zephyr/kernel.h>
+#include "ble_provisioning.h"
+
+// native_sim has no BT controller; provisioning is treated as done
+
+static struct ble_coex_stats coex_stats;
+
+int ble_provisioning_init(void)
+{
+    return 0;
+}
+
+int ble_provisioning_deinit(void)
+{
+    return 0;
+}
+
+bool ble_provisioning_is_enabled(void)
+{
+    return false;
+}
+
+int ble_provisioning_set_advertising(bool enable)
+{
+    return 0;
+}
+
+void ble_provisioning_yield(bool yield)
+{
+}
+
+const struct ble_coex_stats *ble_provisioning_coex_stats(void)
+{
+    return &coex_stats;
+}
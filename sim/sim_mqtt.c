@@ -0,0 +1,210 @@
+#include <zephyr/kernel.h>
+#include <zephyr/net/mqtt.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+#include "config.h"
+#include "aws_mqtt.h"
+#include "sim.h"
+
+LOG_MODULE_REGISTER(sim_mqtt, LOG_LEVEL_INF);
+
+/*
+ * Broker model for the native_sim scenario: same API as handlers/aws_mqtt.c,
+ * with connectivity following the scripted Wi-Fi state and radio energy
+ * charged from the link policy's energy model.
+ */
+
+static struct aws_mqtt_stats stats;
+static uint16_t next_message_id = 1;
+static bool connected;
+static uint16_t keepalive_s;
+static int64_t idle_since_ms;
+static aws_mqtt_puback_cb_t puback_cb;
+
+// PUBACKs the broker will deliver after SIM_BROKER_RTT_MS
+static uint16_t pending_acks[REPLAY_WINDOW_MAX + 1];
+static uint8_t pending_count;
+
+// DTIM listens and keepalive pings while the session sits idle
+static void charge_idle(void)
+{
+    int64_t now = k_uptime_get();
+    int64_t idle_ms = now - idle_since_ms;
+
+    if (connected) {
+        sim_energy_add(SIM_ENERGY_RADIO, idle_ms / LINK_DTIM_PERIOD_MS * LINK_ENERGY_DTIM_UJ);
+        if (keepalive_s) {
+            sim_energy_add(SIM_ENERGY_RADIO,
+                           idle_ms / (keepalive_s * 1000) * LINK_ENERGY_PING_UJ);
+        }
+    }
+    idle_since_ms = now;
+}
+
+static bool link_lost(void)
+{
+    if (connected && !sim_state_get()->wifi_up) {
+        connected = false;
+        pending_count = 0;
+        stats.inflight = 0;
+        stats.disconnects++;
+    }
+
+    return !connected;
+}
+
+int aws_mqtt_init(void)
+{
+    return 0;
+}
+
+int aws_mqtt_connect(void)
+{
+    charge_idle();
+
+    if (connected && !link_lost()) {
+        return 0;
+    }
+
+    if (!sim_state_get()->wifi_up) {
+        return -ENETUNREACH;
+    }
+
+    sim_energy_add(SIM_ENERGY_RADIO, LINK_ENERGY_RECONNECT_UJ);
+    connected = true;
+    stats.connects++;
+
+    return 0;
+}
+
+int aws_mqtt_disconnect(void)
+{
+    charge_idle();
+
+    if (connected) {
+        connected = false;
+        pending_count = 0;
+        stats.inflight = 0;
+        stats.disconnects++;
+    }
+
+    return 0;
+}
+
+void aws_mqtt_release(void)
+{
+    // Pings are charged in charge_idle(); the scenario sends no commands
+}
+
+void aws_mqtt_set_keepalive(uint16_t keepalive)
+{
+    keepalive_s = keepalive;
+}
+
+bool aws_mqtt_is_connected(void)
+{
+    return connected && !link_lost();
+}
+
+int aws_mqtt_process(int timeout_ms)
+{
+    uint16_t acks[ARRAY_SIZE(pending_acks)];
+    uint8_t count;
+
+    if (link_lost()) {
+        return -ENOTCONN;
+    }
+
+    if (pending_count == 0) {
+        k_sleep(K_MSEC(MAX(timeout_ms, 0)));
+        charge_idle();
+        return 0;
+    }
+
+    k_sleep(K_MSEC(MIN(timeout_ms, SIM_BROKER_RTT_MS)));
+    charge_idle();
+
+    count = pending_count;
+    memcpy(acks, pending_acks, count * sizeof(acks[0]));
+    pending_count = 0;
+
+    for (int i = 0; i < count; i++) {
+        stats.pubacks++;
+        if (stats.inflight > 0) {
+            stats.inflight--;
+        }
+        if (puback_cb) {
+            puback_cb(acks[i], 0);
+        }
+    }
+
+    return 0;
+}
+
+void aws_mqtt_set_puback_handler(aws_mqtt_puback_cb_t cb)
+{
+    puback_cb = cb;
+}
+
+int aws_mqtt_subscribe(const char *topic, aws_mqtt_message_cb_t cb)
+{
+    // The scenario sends no commands
+    return 0;
+}
+
+void aws_mqtt_set_session_resumption(bool enable)
+{
+}
+
+int aws_mqtt_clear_retained(const char *topic)
+{
+    return 0;
+}
+
+uint16_t aws_mqtt_next_message_id(void)
+{
+    uint16_t id = next_message_id++;
+
+    if (next_message_id == 0) {
+        next_message_id = 1;
+    }
+
+    return id;
+}
+
+int aws_mqtt_send(const char *topic, const uint8_t *payload, size_t len,
+                  uint8_t qos, uint16_t message_id, bool dup)
+{
+    charge_idle();
+
+    if (link_lost()) {
+        stats.publish_errors++;
+        return -ENOTCONN;
+    }
+
+    sim_energy_add(SIM_ENERGY_RADIO, SIM_PUBLISH_UJ + len * SIM_TX_UJ_PER_BYTE);
+    stats.published++;
+    stats.tx_bytes += len;
+    if (dup) {
+        stats.retransmits++;
+    }
+
+    if (qos == MQTT_QOS_1_AT_LEAST_ONCE && pending_count < ARRAY_SIZE(pending_acks)) {
+        if (!dup) {
+            stats.inflight++;
+        }
+        pending_acks[pending_count++] = message_id;
+    }
+
+    return 0;
+}
+
+int aws_mqtt_publish(const char *topic, const uint8_t *payload, size_t len, uint8_t qos)
+{
+    return aws_mqtt_send(topic, payload, len, qos, aws_mqtt_next_message_id(), false);
+}
+
+const struct aws_mqtt_stats *aws_mqtt_get_stats(void)
+{
+    return &stats;
+}
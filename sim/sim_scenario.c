@@ -0,0 +1,253 @@
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/adc/adc_emul.h>
+#include <zephyr/logging/log.h>
+#include <nsi_main.h>
+#include "config.h"
+#include "app.h"
+#include "aws_mqtt.h"
+#include "data_cache.h"
+#include "histogram.h"
+#include "power_policy.h"
+#include "charge_monitor.h"
+#include "sim.h"
+
+LOG_MODULE_REGISTER(sim, LOG_LEVEL_INF);
+
+#define HOUR(h) ((h) * 3600U)
+
+extern bool wifi_connected;
+
+// Environment at a point of the day, linearly interpolated in between
+struct sim_keyframe {
+    uint32_t t_s;
+    int16_t temperature;
+    uint16_t humidity;
+    uint16_t soil_moisture;
+    uint16_t light_level;
+};
+
+// Cool dark night, light and heat peaking early afternoon, soil drying until
+// it is watered at 18:00
+static const struct sim_keyframe trace[] = {
+    { HOUR(0),       1800, 6000, 5200,    0 },
+    { HOUR(6),       1650, 6500, 4900,    0 },
+    { HOUR(7),       1700, 6300, 4850, 1500 },
+    { HOUR(13),      2600, 4200, 4300, 8500 },
+    { HOUR(18),      2300, 4800, 3900, 2500 },
+    { HOUR(18) + 60, 2300, 4800, 7000, 2500 },
+    { HOUR(20),      2000, 5500, 6800,    0 },
+    { HOUR(24),      1800, 6000, 6500,    0 },
+};
+
+// Soil probe glitches for the spike filter to reject; each one is held until
+// exactly one acquisition has seen it
+static const uint32_t soil_spikes[] = { HOUR(3), HOUR(9), HOUR(15) };
+
+struct sim_window {
+    uint32_t start_s;
+    uint32_t end_s;
+};
+
+static const struct sim_window outages[] = {
+    { HOUR(2), HOUR(2) + 1800 },
+    { HOUR(10), HOUR(13) },
+    { HOUR(21), HOUR(21) + 600 },
+};
+
+static const struct sim_window charge_windows[] = {
+    { HOUR(11), HOUR(15) },
+};
+
+static const struct device *const adc_dev = DEVICE_DT_GET(DT_NODELABEL(adc0));
+
+static struct sim_state state;
+static int64_t battery_uj;
+static uint64_t energy_uj[SIM_ENERGY_COUNT];
+static uint32_t cache_max;
+static int spike_next;
+static uint32_t spike_samples;            // Acquisitions when the spike went up
+static bool spike_active;
+static uint32_t spikes_seen;
+
+static const char *const energy_names[SIM_ENERGY_COUNT] = {
+    [SIM_ENERGY_RADIO] = "radio",
+    [SIM_ENERGY_SENSORS] = "sensors",
+    [SIM_ENERGY_SLEEP] = "sleep",
+};
+
+const struct sim_state *sim_state_get(void)
+{
+    return &state;
+}
+
+void sim_energy_add(enum sim_energy type, uint32_t uj)
+{
+    energy_uj[type] += uj;
+    battery_uj -= uj;
+}
+
+static bool in_window(const struct sim_window *windows, size_t count, uint32_t t_s)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (t_s >= windows[i].start_s && t_s < windows[i].end_s) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static int32_t lerp(int32_t a, int32_t b, uint32_t num, uint32_t den)
+{
+    return a + (b - a) * (int32_t)num / (int32_t)den;
+}
+
+static void update_environment(uint32_t t_s, uint32_t samples)
+{
+    const struct sim_keyframe *a = &trace[0];
+    const struct sim_keyframe *b = &trace[0];
+    uint32_t num;
+    uint32_t den;
+
+    for (int i = 1; i < ARRAY_SIZE(trace); i++) {
+        b = &trace[i];
+        if (t_s < b->t_s) {
+            break;
+        }
+        a = b;
+    }
+
+    num = t_s - a->t_s;
+    den = MAX(b->t_s - a->t_s, 1);
+
+    state.temperature = lerp(a->temperature, b->temperature, num, den);
+    state.humidity = lerp(a->humidity, b->humidity, num, den);
+    state.soil_moisture = lerp(a->soil_moisture, b->soil_moisture, num, den);
+    state.light_level = lerp(a->light_level, b->light_level, num, den);
+
+    if (spike_active && samples != spike_samples) {
+        spike_active = false;
+        spikes_seen++;
+    }
+    if (!spike_active && spike_next < ARRAY_SIZE(soil_spikes) &&
+        t_s >= soil_spikes[spike_next]) {
+        spike_active = true;
+        spike_samples = samples;
+        spike_next++;
+    }
+    if (spike_active) {
+        state.soil_moisture = MIN(state.soil_moisture + 4000, 10000);
+    }
+}
+
+static void update_battery(void)
+{
+    if (state.charging) {
+        battery_uj = MIN(battery_uj + (int64_t)SIM_CHARGE_UW * SIM_STEP_S,
+                         (int64_t)SIM_BATTERY_UJ);
+    }
+    battery_uj = MAX(battery_uj, 0);
+
+    state.soc = battery_uj * 10000 / SIM_BATTERY_UJ;
+    // Rough Li-ion curve, enough for the charge trend detector
+    state.vcell_mv = 3300 + state.soc * 900 / 10000 + (state.charging ? 60 : 0);
+}
+
+// Pin millivolts that the ADC calibration maps back to the scripted values
+static void update_adc(void)
+{
+    adc_emul_const_value_set(adc_dev, ADC_CHANNEL_LIGHT,
+                             LIGHT_ADC_DARK_MV + (LIGHT_ADC_BRIGHT_MV - LIGHT_ADC_DARK_MV) *
+                             state.light_level / 10000);
+    adc_emul_const_value_set(adc_dev, ADC_CHANNEL_SOIL,
+                             SOIL_ADC_DRY_MV + (SOIL_ADC_WET_MV - SOIL_ADC_DRY_MV) *
+                             state.soil_moisture / 10000);
+    adc_emul_const_value_set(adc_dev, ADC_CHANNEL_BATTERY,
+                             state.vcell_mv / BATTERY_DIVIDER_RATIO);
+}
+
+// Workqueue runs that started more than SIM_DEADLINE_SLACK_MS late
+static uint32_t missed_deadlines(void)
+{
+    struct histogram_snapshot snap;
+    uint32_t missed = 0;
+
+    histogram_get(HIST_WORK_JITTER, &snap);
+
+    for (int b = 1; b < HISTOGRAM_BUCKETS; b++) {
+        if (((1U << (b - 1)) << snap.shift) >= SIM_DEADLINE_SLACK_MS * 1000U) {
+            missed += snap.buckets[b];
+        }
+    }
+
+    return missed;
+}
+
+static void report_hour(uint32_t hour)
+{
+    const struct aws_mqtt_stats *mqtt = aws_mqtt_get_stats();
+
+    printk("sim %02u:00  samples %5u  uplinks %4u  msgs %4u  cache %4u  soc %3d%%  tier %d%s%s\n",
+           hour, app_get_stage_stats(APP_STAGE_SENSORS)->count,
+           app_get_stage_stats(APP_STAGE_PUBLISH)->count, mqtt->published,
+           data_cache_depth(), state.soc / 100, power_policy_tier(),
+           state.wifi_up ? "" : "  wifi down", state.charging ? "  charging" : "");
+}
+
+static void report_day(void)
+{
+    const struct aws_mqtt_stats *mqtt = aws_mqtt_get_stats();
+    uint64_t total_uj = 0;
+
+    printk("\n=== %u h scenario ===\n", SIM_DURATION_S / 3600);
+    printk("samples:          %u\n", app_get_stage_stats(APP_STAGE_SENSORS)->count);
+    printk("soil spikes:      %u of %u sampled\n", spikes_seen, (uint32_t)ARRAY_SIZE(soil_spikes));
+    printk("uplinks:          %u\n", app_get_stage_stats(APP_STAGE_PUBLISH)->count);
+    printk("messages:         %u (%u errors)\n", mqtt->published, mqtt->publish_errors);
+    printk("connects:         %u\n", mqtt->connects);
+    printk("cache max/final:  %u / %u\n", cache_max, data_cache_depth());
+    printk("missed deadlines: %u (> %u ms late)\n", missed_deadlines(), SIM_DEADLINE_SLACK_MS);
+    for (int i = 0; i < SIM_ENERGY_COUNT; i++) {
+        printk("energy %-9s  %u mJ\n", energy_names[i], (uint32_t)(energy_uj[i] / 1000));
+        total_uj += energy_uj[i];
+    }
+    printk("energy total:     %u mJ\n", (uint32_t)(total_uj / 1000));
+    printk("soc start/end:    %u%% / %d%%\n", SIM_START_SOC, state.soc / 100);
+}
+
+static void sim_thread(void)
+{
+    uint32_t last_samples = 0;
+
+    battery_uj = (int64_t)SIM_BATTERY_UJ * SIM_START_SOC / 100;
+
+    for (uint32_t t_s = 0; t_s < SIM_DURATION_S; t_s += SIM_STEP_S) {
+        uint32_t samples = app_get_stage_stats(APP_STAGE_SENSORS)->count;
+
+        state.wifi_up = !in_window(outages, ARRAY_SIZE(outages), t_s);
+        state.charging = in_window(charge_windows, ARRAY_SIZE(charge_windows), t_s);
+        wifi_connected = state.wifi_up;
+
+        sim_energy_add(SIM_ENERGY_SLEEP, SIM_SLEEP_UW * SIM_STEP_S);
+        sim_energy_add(SIM_ENERGY_SENSORS, (samples - last_samples) * SIM_SAMPLE_UJ);
+        last_samples = samples;
+
+        update_environment(t_s, samples);
+        update_battery();
+        update_adc();
+
+        cache_max = MAX(cache_max, data_cache_depth());
+        if (t_s % 3600 == 0) {
+            report_hour(t_s / 3600);
+        }
+
+        k_sleep(K_SECONDS(SIM_STEP_S));
+    }
+
+    report_day();
+    nsi_exit(0);
+}
+
+// Runs before the application so the first acquisition sees scripted values
+K_THREAD_DEFINE(sim_tid, 2048, sim_thread, NULL, NULL, NULL, -1, 0, 0);
@@ -0,0 +1,182 @@
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <stdlib.h>
+#include "config.h"
+#include "aws_mqtt.h"
+#include "data_cache.h"
+#include "cache_replay.h"
+#include "plant_data.h"
+#include "sensor_health.h"
+#include "credentials.h"
+#if defined(CONFIG_MBEDTLS_MEMORY_DEBUG)
+#include <mbedtls/memory_buffer_alloc.h>
+#endif
+
+/*
+ * On-target benchmarks, run from the shell against a local broker stand-in
+ * (point AWS_ENDPOINT at it). Not built into production images.
+ */
+
+#if APP_BENCH_ENABLED && defined(CONFIG_SHELL)
+
+static const uint8_t bench_windows[] = { 1, 4, 16 };
+
+static int fill_cache(uint32_t records)
+{
+    struct plant_sample sample = {
+        .temperature = 2150,
+        .humidity = 4820,
+        .soil_moisture = 3710,
+        .light_level = 6200,
+        .battery_mv = 3980,
+        .battery_level = 88,
+        .valid = BIT(SENSOR_COUNT) - 1,
+    };
+    int ret;
+
+    for (uint32_t i = 0; i < records; i++) {
+        sample.timestamp = i;
+        ret = data_cache_append(&sample, 1);
+        if (ret) {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+static int cmd_bench_replay(const struct shell *sh, size_t argc, char **argv)
+{
+    struct cache_replay_result res;
+    uint32_t records = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCH_REPLAY_RECORDS;
+    int ret;
+
+    if (data_cache_depth() > 0) {
+        shell_error(sh, "Offline cache not empty (%u records), drain it first",
+                    data_cache_depth());
+        return -EBUSY;
+    }
+
+    ret = aws_mqtt_connect();
+    if (ret) {
+        shell_error(sh, "Broker connect failed: %d", ret);
+        return ret;
+    }
+
+    shell_print(sh, "window  records  retries  ms      rec/s  final_window");
+    for (int i = 0; i < ARRAY_SIZE(bench_windows); i++) {
+        ret = fill_cache(records);
+        if (ret) {
+            shell_error(sh, "Cache fill failed: %d", ret);
+            return ret;
+        }
+
+        ret = cache_replay_run(BENCH_TOPIC, bench_windows[i], 0, &res);
+        shell_print(sh, "%6u  %7u  %7u  %6u  %5u  %12u%s",
+                    bench_windows[i], res.acked, res.retries, res.elapsed_ms,
+                    res.elapsed_ms ? res.acked * 1000U / res.elapsed_ms : 0,
+                    res.final_window, ret ? "  (incomplete)" : "");
+    }
+
+    aws_mqtt_release();
+
+    return 0;
+}
+
+#if defined(CONFIG_MQTT_LIB_TLS)
+static int bench_connect(uint32_t *elapsed_ms)
+{
+    int64_t deadline = k_uptime_get() + AWS_MQTT_CONNECT_TIMEOUT_MS;
+    int64_t start;
+    int ret;
+
+    aws_mqtt_disconnect();
+    while (aws_mqtt_is_connected() && k_uptime_get() < deadline) {
+        aws_mqtt_process(REPLAY_POLL_MS);
+    }
+
+    start = k_uptime_get();
+    ret = aws_mqtt_connect();
+    *elapsed_ms = k_uptime_get() - start;
+
+    return ret;
+}
+
+// Run once with an RSA-2048 and once with a P-256 device key provisioned
+static int cmd_bench_tls(const struct shell *sh, size_t argc, char **argv)
+{
+    uint32_t rounds = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCH_TLS_ROUNDS;
+    uint32_t min_ms = UINT32_MAX;
+    uint32_t max_ms = 0;
+    uint32_t total_ms = 0;
+    uint32_t resumed_ms;
+    uint32_t ms;
+    int ret = 0;
+#if defined(CONFIG_MBEDTLS_MEMORY_DEBUG)
+    size_t peak_bytes;
+    size_t peak_blocks;
+#endif
+
+    shell_print(sh, "device key: %s, records %u bytes, MFL %s",
+                credentials_key_name(credentials_key_type()), CONFIG_MBEDTLS_SSL_MAX_CONTENT_LEN,
+                IS_ENABLED(CONFIG_MBEDTLS_SSL_MAX_FRAGMENT_LENGTH) ? "on" : "off");
+#if defined(CONFIG_MBEDTLS_MEMORY_DEBUG)
+    mbedtls_memory_buffer_alloc_max_reset();
+#endif
+
+    // Full handshakes: nothing cached to resume
+    aws_mqtt_set_session_resumption(false);
+    for (uint32_t i = 0; i < rounds; i++) {
+        ret = bench_connect(&ms);
+        if (ret) {
+            shell_error(sh, "Broker connect failed: %d", ret);
+            break;
+        }
+        min_ms = MIN(min_ms, ms);
+        max_ms = MAX(max_ms, ms);
+        total_ms += ms;
+    }
+    aws_mqtt_set_session_resumption(true);
+
+    if (ret || rounds == 0) {
+        return ret;
+    }
+
+    // Prime the cache, then time an abbreviated handshake for reference
+    ret = bench_connect(&ms);
+    if (ret == 0) {
+        ret = bench_connect(&resumed_ms);
+    }
+
+    shell_print(sh, "full handshake:    avg %u ms  min %u  max %u  (%u rounds)",
+                total_ms / rounds, min_ms, max_ms, rounds);
+    shell_print(sh, "energy per connect: %u uJ at %u mW",
+                total_ms / rounds * BENCH_ACTIVE_MW, BENCH_ACTIVE_MW);
+    if (ret == 0) {
+        shell_print(sh, "resumed handshake: %u ms", resumed_ms);
+    }
+#if defined(CONFIG_MBEDTLS_MEMORY_DEBUG)
+    mbedtls_memory_buffer_alloc_max_get(&peak_bytes, &peak_blocks);
+    shell_print(sh, "mbedTLS heap peak: %u bytes in %u blocks",
+                (uint32_t)peak_bytes, (uint32_t)peak_blocks);
+#endif
+
+    aws_mqtt_release();
+
+    return 0;
+}
+#endif /* CONFIG_MQTT_LIB_TLS */
+
+SHELL_STATIC_SUBCMD_SET_CREATE(bench_cmds,
+    SHELL_CMD_ARG(replay, NULL, "Cache drain rate at window 1/4/16 [records]",
+                  cmd_bench_replay, 1, 1),
+#if defined(CONFIG_MQTT_LIB_TLS)
+    SHELL_CMD_ARG(tls, NULL, "Full and resumed TLS connect time with the device key [rounds]",
+                  cmd_bench_tls, 1, 1),
+#endif
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(bench, &bench_cmds, "On-target benchmarks", NULL);
+
+#endif /* APP_BENCH_ENABLED && CONFIG_SHELL */
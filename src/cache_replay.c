@@ -0,0 +1,218 @@
+#include <zephyr/kernel.h>
+#include <zephyr/net/mqtt.h>
+#include <zephyr/logging/log.h>
+#include "config.h"
+#include "aws_mqtt.h"
+#include "data_cache.h"
+#include "qos_policy.h"
+#include "plant_data.h"
+#include "cache_replay.h"
+
+LOG_MODULE_REGISTER(cache_replay, LOG_LEVEL_INF);
+
+// One outstanding QoS1 message
+struct replay_slot {
+    bool used;
+    uint8_t retries;
+    uint16_t message_id;
+    off_t offset;             // Offset of the record in the cache file
+    int64_t sent_ms;
+    struct plant_sample sample;
+};
+
+static struct replay_slot slots[REPLAY_WINDOW_MAX];
+static uint8_t inflight;
+static uint8_t window;
+static uint8_t window_max;
+static struct cache_replay_result stats;
+static uint32_t total_retries;
+
+static void replay_puback(uint16_t message_id, int result)
+{
+    for (int i = 0; i < ARRAY_SIZE(slots); i++) {
+        if (!slots[i].used || slots[i].message_id != message_id) {
+            continue;
+        }
+
+        if (result != 0) {
+            // Rejected by the broker, leave it to the timeout path
+            return;
+        }
+
+        slots[i].used = false;
+        inflight--;
+        stats.acked++;
+
+        // Additive increase
+        if (window < window_max) {
+            window++;
+        }
+        return;
+    }
+}
+
+// Records are formatted when sent; a retransmission formats the same bytes
+static int send_slot(const char *topic, const struct replay_slot *slot, bool dup)
+{
+    char payload[PAYLOAD_RECORD_MAX];
+    int len;
+
+    len = plant_data_format(&slot->sample, payload, sizeof(payload));
+    if (len < 0) {
+        return len;
+    }
+
+    return aws_mqtt_send(topic, (const uint8_t *)payload, len,
+                         qos_policy_select(MSG_CLASS_REPLAY), slot->message_id, dup);
+}
+
+static struct replay_slot *free_slot(void)
+{
+    for (int i = 0; i < window_max; i++) {
+        if (!slots[i].used) {
+            return &slots[i];
+        }
+    }
+
+    return NULL;
+}
+
+// Records before this offset have all been acknowledged
+static off_t acked_offset(off_t read_offset)
+{
+    off_t lowest = read_offset;
+
+    for (int i = 0; i < ARRAY_SIZE(slots); i++) {
+        if (slots[i].used && slots[i].offset < lowest) {
+            lowest = slots[i].offset;
+        }
+    }
+
+    return lowest;
+}
+
+static int check_timeouts(const char *topic)
+{
+    int64_t now = k_uptime_get();
+    int ret;
+
+    for (int i = 0; i < window_max; i++) {
+        struct replay_slot *slot = &slots[i];
+
+        if (!slot->used || now - slot->sent_ms < REPLAY_ACK_TIMEOUT_MS) {
+            continue;
+        }
+
+        if (slot->retries >= REPLAY_MAX_RETRIES) {
+            LOG_WRN("Message %u unacknowledged after %u retries",
+                    slot->message_id, slot->retries);
+            return -ETIMEDOUT;
+        }
+
+        // Multiplicative decrease
+        window = MAX(window / 2, 1);
+
+        ret = send_slot(topic, slot, true);
+        if (ret) {
+            return ret;
+        }
+
+        slot->retries++;
+        slot->sent_ms = now;
+        stats.retries++;
+        total_retries++;
+    }
+
+    return 0;
+}
+
+int cache_replay_run(const char *topic, uint8_t max_window, uint32_t max_records,
+                     struct cache_replay_result *result)
+{
+    struct replay_slot *slot;
+    off_t read_offset = 0;
+    bool eof = false;
+    int64_t start = k_uptime_get();
+    int ret = 0;
+
+    memset(slots, 0, sizeof(slots));
+    memset(&stats, 0, sizeof(stats));
+    inflight = 0;
+    window_max = CLAMP(max_window, 1, REPLAY_WINDOW_MAX);
+    window = window_max;
+
+    aws_mqtt_set_puback_handler(replay_puback);
+
+    while (!eof || inflight > 0) {
+        // Fill the window
+        while (!eof && inflight < window && (slot = free_slot()) != NULL) {
+            off_t offset = read_offset;
+
+            if (max_records && stats.sent >= max_records) {
+                eof = true;
+                break;
+            }
+
+            ret = data_cache_read(&read_offset, &slot->sample);
+            if (ret <= 0) {
+                eof = true;
+                break;
+            }
+
+            slot->offset = offset;
+            slot->retries = 0;
+            slot->message_id = aws_mqtt_next_message_id();
+            slot->sent_ms = k_uptime_get();
+
+            ret = send_slot(topic, slot, false);
+            if (ret) {
+                // Not sent, so it must be read again next time
+                read_offset = offset;
+                goto out;
+            }
+
+            slot->used = true;
+            inflight++;
+            stats.sent++;
+        }
+
+        if (inflight == 0) {
+            continue;
+        }
+
+        ret = aws_mqtt_process(REPLAY_POLL_MS);
+        if (ret == 0) {
+            ret = check_timeouts(topic);
+        }
+        if (ret) {
+            goto out;
+        }
+    }
+
+    ret = 0;
+
+out:
+    aws_mqtt_set_puback_handler(NULL);
+
+    stats.final_window = window;
+    stats.elapsed_ms = k_uptime_get() - start;
+    if (result) {
+        *result = stats;
+    }
+
+    data_cache_discard(acked_offset(read_offset));
+
+    if (ret) {
+        LOG_WRN("Cache replay stopped: %d (%u of %u acknowledged)", ret, stats.acked, stats.sent);
+    } else {
+        LOG_INF("Cache drained: %u records in %u ms, %u retries",
+                stats.acked, stats.elapsed_ms, stats.retries);
+    }
+
+    return ret;
+}
+
+uint32_t cache_replay_total_retries(void)
+{
+    return total_retries;
+}
@@ -0,0 +1,62 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "config.h"
+#include "charge_monitor.h"
+
+LOG_MODULE_REGISTER(charge_monitor, LOG_LEVEL_INF);
+
+// Recent gauge readings, oldest first once the window is full
+static int32_t vcell_hist[CHARGE_TREND_SAMPLES];
+static int16_t soc_hist[CHARGE_TREND_SAMPLES];   // SOC in 0.1 % steps
+static uint8_t hist_len;
+static uint8_t hist_head;
+static bool charging;
+static int32_t trend_mv;
+
+bool charge_monitor_update(int32_t vcell_mv, float soc)
+{
+    uint8_t oldest;
+    int32_t soc_trend;
+    bool now_charging;
+
+    vcell_hist[hist_head] = vcell_mv;
+    soc_hist[hist_head] = (int16_t)(soc * 10.0f);
+    hist_head = (hist_head + 1) % CHARGE_TREND_SAMPLES;
+    if (hist_len < CHARGE_TREND_SAMPLES) {
+        hist_len++;
+        return false;
+    }
+
+    // With a full ring the head points at the oldest entry
+    oldest = hist_head;
+    trend_mv = vcell_mv - vcell_hist[oldest];
+    soc_trend = soc_hist[(hist_head + CHARGE_TREND_SAMPLES - 1) % CHARGE_TREND_SAMPLES] -
+                soc_hist[oldest];
+
+    // Start on a clear rise, stop only once the rise has gone flat
+    if (charging) {
+        now_charging = trend_mv > 0 || soc_trend > 0;
+    } else {
+        now_charging = trend_mv >= CHARGE_START_RISE_MV && soc_trend >= 0;
+    }
+
+    if (now_charging == charging) {
+        return false;
+    }
+
+    charging = now_charging;
+    LOG_INF("Charging %s (VCELL %+d mV over %d samples)",
+            charging ? "started" : "stopped", trend_mv, CHARGE_TREND_SAMPLES);
+
+    return true;
+}
+
+bool charge_monitor_is_charging(void)
+{
+    return charging;
+}
+
+int32_t charge_monitor_trend_mv(void)
+{
+    return trend_mv;
+}
@@ -0,0 +1,317 @@
+#include <zephyr/kernel.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/logging/log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "config.h"
+#include "data_cache.h"
+
+LOG_MODULE_REGISTER(data_cache, LOG_LEVEL_INF);
+
+#define RECORD_SIZE sizeof(struct plant_sample)
+#define SEGMENT_BYTES (CACHE_SEGMENT_RECORDS * RECORD_SIZE)
+#define HEAD_PATH CACHE_DIR "/head"
+
+// Acknowledged part of the oldest segment, persisted so a reboot does not
+// send it again
+struct cache_head {
+    uint32_t segment;
+    uint32_t offset;
+};
+
+static atomic_t depth;
+static uint32_t first_seg;            // Oldest segment
+static uint32_t next_seg;             // One past the newest, first_seg when empty
+static off_t head;
+
+static void segment_path(char *path, size_t size, uint32_t seg)
+{
+    snprintf(path, size, CACHE_DIR "/%u", seg);
+}
+
+// A torn write at the tail is not counted and reads as the end
+static ssize_t segment_size(uint32_t seg)
+{
+    struct fs_dirent entry;
+    char path[32];
+    int ret;
+
+    segment_path(path, sizeof(path), seg);
+    ret = fs_stat(path, &entry);
+    if (ret) {
+        return ret;
+    }
+
+    return entry.size - entry.size % RECORD_SIZE;
+}
+
+static int save_head(void)
+{
+    struct cache_head h = { .segment = first_seg, .offset = head };
+    struct fs_file_t file;
+    ssize_t written;
+    int ret;
+
+    fs_file_t_init(&file);
+
+    ret = fs_open(&file, HEAD_PATH, FS_O_CREATE | FS_O_WRITE);
+    if (ret) {
+        LOG_ERR("Failed to open cache head: %d", ret);
+        return ret;
+    }
+
+    written = fs_write(&file, &h, sizeof(h));
+    fs_close(&file);
+
+    return written == sizeof(h) ? 0 : -EIO;
+}
+
+static void load_head(void)
+{
+    struct cache_head h;
+    struct fs_file_t file;
+    ssize_t len;
+
+    head = 0;
+    fs_file_t_init(&file);
+
+    if (fs_open(&file, HEAD_PATH, FS_O_READ)) {
+        return;
+    }
+    len = fs_read(&file, &h, sizeof(h));
+    fs_close(&file);
+
+    // Saved for a segment that has since been removed: start it over
+    if (len == sizeof(h) && first_seg != next_seg && h.segment == first_seg &&
+        h.offset % RECORD_SIZE == 0 && (ssize_t)h.offset <= segment_size(first_seg)) {
+        head = h.offset;
+    }
+}
+
+// Appending after a torn record would misalign everything behind it
+static void trim_newest(void)
+{
+    struct fs_file_t file;
+    char path[32];
+
+    segment_path(path, sizeof(path), next_seg - 1);
+    fs_file_t_init(&file);
+
+    if (fs_open(&file, path, FS_O_WRITE) == 0) {
+        fs_truncate(&file, segment_size(next_seg - 1));
+        fs_close(&file);
+    }
+}
+
+// The flat file of earlier firmware, and a copy left over from its
+// compaction, become the newest segment
+static void migrate_flat_file(void)
+{
+    struct fs_dirent entry;
+    char path[32];
+
+    if (fs_stat(CACHE_FILE_PATH ".tmp", &entry) == 0) {
+        if (fs_stat(CACHE_FILE_PATH, &entry) == 0) {
+            fs_unlink(CACHE_FILE_PATH ".tmp");
+        } else {
+            fs_rename(CACHE_FILE_PATH ".tmp", CACHE_FILE_PATH);
+        }
+    }
+
+    if (fs_stat(CACHE_FILE_PATH, &entry) == 0) {
+        segment_path(path, sizeof(path), next_seg);
+        if (fs_rename(CACHE_FILE_PATH, path) == 0) {
+            next_seg++;
+            LOG_INF("Migrated flat cache file");
+        }
+    }
+}
+
+int data_cache_init(void)
+{
+    struct fs_dir_t dir;
+    struct fs_dirent entry;
+    uint32_t lo = UINT32_MAX;
+    uint32_t hi = 0;
+    uint64_t bytes = 0;
+    ssize_t size;
+    uint32_t records;
+    char *end;
+    int ret;
+
+    // Records from before the fixed-size format cannot be replayed
+    fs_unlink(CACHE_LEGACY_FILE_PATH);
+
+    ret = fs_mkdir(CACHE_DIR);
+    if (ret && ret != -EEXIST) {
+        LOG_ERR("Failed to create cache directory: %d", ret);
+        return ret;
+    }
+
+    fs_dir_t_init(&dir);
+    ret = fs_opendir(&dir, CACHE_DIR);
+    if (ret) {
+        LOG_ERR("Failed to open cache directory: %d", ret);
+        return ret;
+    }
+
+    while (fs_readdir(&dir, &entry) == 0 && entry.name[0]) {
+        unsigned long seg = strtoul(entry.name, &end, 10);
+
+        if (entry.type != FS_DIR_ENTRY_FILE || end == entry.name || *end) {
+            continue;
+        }
+        lo = MIN(lo, seg);
+        hi = MAX(hi, seg);
+    }
+    fs_closedir(&dir);
+
+    first_seg = lo == UINT32_MAX ? 0 : lo;
+    next_seg = lo == UINT32_MAX ? 0 : hi + 1;
+
+    migrate_flat_file();
+    load_head();
+
+    if (first_seg != next_seg) {
+        trim_newest();
+    }
+
+    for (uint32_t seg = first_seg; seg < next_seg; seg++) {
+        size = segment_size(seg);
+        if (size > 0) {
+            bytes += size;
+        }
+    }
+
+    records = (bytes - head) / RECORD_SIZE;
+    atomic_set(&depth, records);
+    LOG_INF("Offline cache holds %u records in %u segment(s)", records, next_seg - first_seg);
+
+    return 0;
+}
+
+int data_cache_append(const struct plant_sample *samples, size_t count)
+{
+    struct fs_file_t file;
+    size_t len = count * sizeof(*samples);
+    ssize_t written;
+    char path[32];
+    int ret;
+
+    // Fill the newest segment up to SEGMENT_BYTES, then start another
+    if (first_seg == next_seg || segment_size(next_seg - 1) >= SEGMENT_BYTES) {
+        next_seg++;
+    }
+    segment_path(path, sizeof(path), next_seg - 1);
+
+    fs_file_t_init(&file);
+
+    ret = fs_open(&file, path, FS_O_CREATE | FS_O_WRITE | FS_O_APPEND);
+    if (ret) {
+        LOG_ERR("Failed to open cache file: %d", ret);
+        return ret;
+    }
+
+    written = fs_write(&file, samples, len);
+    fs_close(&file);
+
+    if (written < 0) {
+        LOG_ERR("Failed to write to cache file: %d", (int)written);
+        return written;
+    }
+    if (written != len) {
+        LOG_ERR("Short write to cache file");
+        return -ENOSPC;
+    }
+
+    atomic_add(&depth, count);
+    LOG_INF("Cached %u sample(s) locally", (uint32_t)count);
+
+    return 0;
+}
+
+int data_cache_read(off_t *offset, struct plant_sample *sample)
+{
+    struct fs_file_t file;
+    off_t pos = head + *offset;
+    ssize_t size;
+    ssize_t len;
+    char path[32];
+    int ret;
+
+    for (uint32_t seg = first_seg; seg < next_seg; seg++) {
+        size = segment_size(seg);
+        if (size < 0) {
+            return size == -ENOENT ? 0 : size;
+        }
+        if (pos >= size) {
+            pos -= size;
+            continue;
+        }
+
+        segment_path(path, sizeof(path), seg);
+        fs_file_t_init(&file);
+
+        ret = fs_open(&file, path, FS_O_READ);
+        if (ret) {
+            LOG_ERR("Failed to open cache file: %d", ret);
+            return ret;
+        }
+
+        ret = fs_seek(&file, pos, FS_SEEK_SET);
+        if (ret) {
+            fs_close(&file);
+            return ret;
+        }
+
+        len = fs_read(&file, sample, sizeof(*sample));
+        fs_close(&file);
+
+        if (len < 0) {
+            return len;
+        }
+        if (len < sizeof(*sample)) {
+            return 0;
+        }
+
+        *offset += len;
+        return len;
+    }
+
+    return 0;
+}
+
+int data_cache_discard(off_t offset)
+{
+    off_t pos = head + offset;
+    ssize_t size;
+    char path[32];
+
+    if (offset == 0) {
+        return 0;
+    }
+
+    // Only segments acknowledged in full are removed; within the oldest one
+    // the head moves instead, so nothing is copied
+    while (first_seg < next_seg) {
+        size = segment_size(first_seg);
+        if (size >= 0 && pos < size) {
+            break;
+        }
+
+        segment_path(path, sizeof(path), first_seg);
+        fs_unlink(path);
+        pos -= MAX(size, 0);
+        first_seg++;
+    }
+
+    head = first_seg == next_seg ? 0 : pos;
+    atomic_sub(&depth, MIN(offset / RECORD_SIZE, atomic_get(&depth)));
+
+    return save_head();
+}
+
+uint32_t data_cache_depth(void)
+{
+    return atomic_get(&depth);
+}
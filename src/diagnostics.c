@@ -0,0 +1,167 @@
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/drivers/hwinfo.h>
+#include <zephyr/sys/sys_heap.h>
+#include <zephyr/logging/log.h>
+#include <stdio.h>
+#include "config.h"
+#include "app.h"
+#include "aws_mqtt.h"
+#include "data_cache.h"
+#include "qos_policy.h"
+#include "cache_replay.h"
+#include "power_policy.h"
+#include "charge_monitor.h"
+#include "histogram.h"
+#include "link_quality.h"
+#include "tx_power.h"
+#include "diagnostics.h"
+
+LOG_MODULE_REGISTER(diagnostics, LOG_LEVEL_INF);
+
+extern struct k_heap _system_heap;
+
+static const char *const hist_keys[HIST_COUNT] = {
+    [HIST_PUBLISH_RTT] = "hl",
+    [HIST_WORK_JITTER] = "hj",
+    [HIST_SENSOR_READ] = "hs",
+};
+
+static uint32_t boot_count;
+static uint32_t reset_cause;
+static uint32_t uplinks;
+
+static int diag_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+    const char *next;
+    int ret;
+
+    if (settings_name_steq(name, "boot_count", &next) && !next) {
+        if (len != sizeof(boot_count)) {
+            return -EINVAL;
+        }
+        ret = read_cb(cb_arg, &boot_count, sizeof(boot_count));
+        return ret < 0 ? ret : 0;
+    }
+
+    return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(diag, "diag", NULL, diag_set, NULL, NULL);
+
+void diagnostics_init(void)
+{
+    int ret;
+
+    boot_count++;
+    ret = settings_save_one("diag/boot_count", &boot_count, sizeof(boot_count));
+    if (ret) {
+        LOG_ERR("Failed to save boot count: %d", ret);
+    }
+
+    if (hwinfo_get_reset_cause(&reset_cause) == 0) {
+        hwinfo_clear_reset_cause();
+    }
+
+    LOG_INF("Boot %u, reset cause 0x%x", boot_count, reset_cause);
+}
+
+bool diagnostics_uplink_tick(void)
+{
+    return (uplinks++ % DIAG_EVERY_N_UPLINKS) == 0;
+}
+
+int diagnostics_heap_stats(size_t *free_bytes, size_t *max_allocated)
+{
+#if defined(CONFIG_SYS_HEAP_RUNTIME_STATS)
+    struct sys_memory_stats heap;
+    int ret;
+
+    ret = sys_heap_runtime_stats_get(&_system_heap.heap, &heap);
+    if (ret) {
+        return ret;
+    }
+
+    *free_bytes = heap.free_bytes;
+    *max_allocated = heap.max_allocated_bytes;
+
+    return 0;
+#else
+    return -ENOTSUP;
+#endif
+}
+
+// Short keys keep the record to one small packet:
+//  b  boot count            r  reset cause bitmask
+//  hu heap bytes in use     hm heap high-watermark
+//  sf workqueue stack bytes never used
+//  cd cache depth           rc reconnect attempts
+//  pe publish errors        rs Wi-Fi RSSI (dBm)
+//  ct average cycle time (ms) ps PUBACK round trips saved by QoS0
+//  rt replay retransmissions  pt active battery power tier
+//  ch charging (boost active)
+//  rr Wi-Fi TX failures plus MQTT retransmissions
+//  ab radio-on us per payload byte, last uplink window
+//  dw uplinks deferred for a weak signal
+//  tp Wi-Fi TX power limit (0.25 dBm)  te TX energy saved (mJ)
+//  hl/hj/hs publish RTT, work jitter and sensor read histograms,
+//           [first bucket, counts...] in log2 buckets
+int diagnostics_format(char *buf, size_t size)
+{
+    const struct aws_mqtt_stats *mqtt = aws_mqtt_get_stats();
+    const struct app_stage_stats *cycle = app_get_stage_stats(APP_STAGE_CYCLE);
+    const struct link_quality_stats *lq = link_quality_get();
+    const struct tx_power_state *txp = tx_power_get();
+    struct sys_memory_stats heap = {0};
+    size_t stack_unused = 0;
+    size_t len;
+    int ret;
+
+#if defined(CONFIG_SYS_HEAP_RUNTIME_STATS)
+    sys_heap_runtime_stats_get(&_system_heap.heap, &heap);
+#endif
+#if defined(CONFIG_THREAD_STACK_INFO)
+    k_thread_stack_space_get(&k_sys_work_q.thread, &stack_unused);
+#endif
+
+    ret = snprintf(buf, size,
+                   "{\"b\":%u,\"r\":%u,\"hu\":%u,\"hm\":%u,\"sf\":%u,"
+                   "\"cd\":%u,\"rc\":%u,\"pe\":%u,\"rs\":%d,\"ct\":%u,\"ps\":%u,\"rt\":%u,\"pt\":%d,\"ch\":%d,"
+                   "\"rr\":%u,\"ab\":%u,\"dw\":%u,\"tp\":%d,\"te\":%u",
+                   boot_count, reset_cause,
+                   (uint32_t)heap.allocated_bytes, (uint32_t)heap.max_allocated_bytes,
+                   (uint32_t)stack_unused,
+                   data_cache_depth(), app_get_reconnect_attempts(),
+                   mqtt->publish_errors, link_quality_rssi(),
+                   cycle->count ? (uint32_t)(cycle->total_us / cycle->count / 1000) : 0,
+                   qos_policy_pubacks_saved(), cache_replay_total_retries(),
+                   power_policy_tier(), charge_monitor_is_charging(),
+                   lq->retries, lq->last_us_per_byte, lq->deferred,
+                   txp->level_qdbm, txp->saved_uj / 1000U);
+    if (ret < 0 || ret >= size) {
+        return -ENOMEM;
+    }
+    len = ret;
+
+    for (int i = 0; i < HIST_COUNT; i++) {
+        ret = snprintf(buf + len, size - len, ",\"%s\":", hist_keys[i]);
+        if (ret < 0 || ret >= size - len) {
+            return -ENOMEM;
+        }
+        len += ret;
+
+        ret = histogram_format(i, buf + len, size - len);
+        if (ret < 0) {
+            return ret;
+        }
+        len += ret;
+    }
+
+    if (len + 1 >= size) {
+        return -ENOMEM;
+    }
+    buf[len++] = '}';
+    buf[len] = '\0';
+
+    return len;
+}
@@ -0,0 +1,106 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <stdio.h>
+#include "config.h"
+#include "histogram.h"
+
+struct histogram {
+    atomic_t buckets[HISTOGRAM_BUCKETS];
+    atomic_t count;
+    atomic_t max_us;
+    uint8_t shift;
+};
+
+// Shifts put each histogram's interesting range inside 16 log2 buckets:
+// ~1 ms units up to ~30 s for network and scheduling, 64 us up to ~2 s for
+// sensor reads.
+static struct histogram hists[HIST_COUNT] = {
+    [HIST_PUBLISH_RTT] = { .shift = 10 },
+    [HIST_WORK_JITTER] = { .shift = 10 },
+    [HIST_SENSOR_READ] = { .shift = 6 },
+};
+
+static const char *const hist_names[HIST_COUNT] = {
+    [HIST_PUBLISH_RTT] = "publish_rtt",
+    [HIST_WORK_JITTER] = "work_jitter",
+    [HIST_SENSOR_READ] = "sensor_read",
+};
+
+void histogram_record(enum hist_id id, uint32_t value_us)
+{
+    struct histogram *h = &hists[id];
+    uint32_t scaled = value_us >> h->shift;
+    uint32_t bucket = scaled ? 32 - __builtin_clz(scaled) : 0;
+    atomic_val_t max;
+
+    atomic_inc(&h->buckets[MIN(bucket, HISTOGRAM_BUCKETS - 1)]);
+    atomic_inc(&h->count);
+
+    do {
+        max = atomic_get(&h->max_us);
+    } while ((uint32_t)max < value_us && !atomic_cas(&h->max_us, max, value_us));
+}
+
+void histogram_get(enum hist_id id, struct histogram_snapshot *snap)
+{
+    struct histogram *h = &hists[id];
+
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        snap->buckets[i] = atomic_get(&h->buckets[i]);
+    }
+    snap->count = atomic_get(&h->count);
+    snap->max_us = atomic_get(&h->max_us);
+    snap->shift = h->shift;
+}
+
+const char *histogram_name(enum hist_id id)
+{
+    return hist_names[id];
+}
+
+int histogram_format(enum hist_id id, char *buf, size_t size)
+{
+    struct histogram_snapshot snap;
+    int first = -1;
+    int last = -1;
+    size_t len;
+    int ret;
+
+    histogram_get(id, &snap);
+
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (snap.buckets[i]) {
+            if (first < 0) {
+                first = i;
+            }
+            last = i;
+        }
+    }
+
+    if (first < 0) {
+        ret = snprintf(buf, size, "[]");
+        return (ret < 0 || ret >= size) ? -ENOMEM : ret;
+    }
+
+    ret = snprintf(buf, size, "[%d", first);
+    if (ret < 0 || ret >= size) {
+        return -ENOMEM;
+    }
+    len = ret;
+
+    for (int i = first; i <= last; i++) {
+        ret = snprintf(buf + len, size - len, ",%u", snap.buckets[i]);
+        if (ret < 0 || ret >= size - len) {
+            return -ENOMEM;
+        }
+        len += ret;
+    }
+
+    if (len + 1 >= size) {
+        return -ENOMEM;
+    }
+    buf[len++] = ']';
+    buf[len] = '\0';
+
+    return len;
+}
@@ -0,0 +1,44 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "config.h"
+#include "aws_mqtt.h"
+#include "link_policy.h"
+
+LOG_MODULE_REGISTER(link_policy, LOG_LEVEL_INF);
+
+static struct link_policy_decision decision;
+
+void link_policy_update(uint32_t uplink_interval_ms)
+{
+    uint32_t interval_s = DIV_ROUND_UP(uplink_interval_ms, 1000);
+    uint32_t keepalive_s;
+    uint32_t pings;
+    uint64_t stay_uj;
+
+    // A keepalive just longer than the uplink interval means every publish
+    // resets the timer and no PINGREQ is ever needed
+    keepalive_s = MIN(interval_s + LINK_KEEPALIVE_MARGIN_S, LINK_KEEPALIVE_MAX_S);
+    pings = interval_s < keepalive_s ? 0 : interval_s / keepalive_s;
+
+    stay_uj = (uint64_t)pings * LINK_ENERGY_PING_UJ +
+              (uint64_t)uplink_interval_ms / LINK_DTIM_PERIOD_MS * LINK_ENERGY_DTIM_UJ;
+
+    decision.uplink_interval_ms = uplink_interval_ms;
+    decision.keepalive_s = keepalive_s;
+    decision.stay_cost_uj = MIN(stay_uj, UINT32_MAX);
+    decision.reconnect_cost_uj = LINK_ENERGY_RECONNECT_UJ;
+    decision.mode = decision.stay_cost_uj < decision.reconnect_cost_uj ?
+                    LINK_MODE_STAY_CONNECTED : LINK_MODE_DISCONNECT;
+
+    aws_mqtt_set_keepalive(keepalive_s);
+
+    LOG_INF("Uplink every %u s: %s (keepalive %u s, stay %u uJ, reconnect %u uJ)",
+            interval_s,
+            decision.mode == LINK_MODE_STAY_CONNECTED ? "stay connected" : "disconnect",
+            keepalive_s, decision.stay_cost_uj, decision.reconnect_cost_uj);
+}
+
+const struct link_policy_decision *link_policy_get(void)
+{
+    return &decision;
+}
@@ -0,0 +1,177 @@
+#include <zephyr/kernel.h>
+#include <zephyr/net/net_if.h>
+#include <zephyr/net/net_mgmt.h>
+#include <zephyr/net/net_stats.h>
+#include <zephyr/net/wifi_mgmt.h>
+#include <zephyr/logging/log.h>
+#include "config.h"
+#include "aws_mqtt.h"
+#include "link_quality.h"
+
+LOG_MODULE_REGISTER(link_quality, LOG_LEVEL_INF);
+
+#define SLOT_MS (60 * 60 * 1000)
+
+static struct link_quality_stats stats;
+
+// Per-hour RSSI moving average in 1/16 dBm; there is no wall clock, so hours
+// of uptime stand in for time of day on a node that runs continuously
+static int16_t slot_rssi_x16[LINK_QUALITY_SLOTS];
+static bool slot_seen[LINK_QUALITY_SLOTS];
+
+// Counters at the start of the current uplink window
+static int64_t window_start_ms;
+static uint32_t window_tx_errors;
+static uint32_t window_tx_packets;
+static uint32_t window_retransmits;
+static uint32_t window_tx_bytes;
+
+int link_quality_rssi(void)
+{
+#if defined(CONFIG_WIFI)
+    struct net_if *iface = net_if_get_default();
+    struct wifi_iface_status status = {0};
+
+    if (!iface ||
+        net_mgmt(NET_REQUEST_WIFI_IFACE_STATUS, iface, &status, sizeof(status))) {
+        return 0;
+    }
+
+    if (status.state < WIFI_STATE_ASSOCIATED) {
+        return 0;
+    }
+
+    return status.rssi;
+#else
+    return 0;
+#endif
+}
+
+static void wifi_tx_counters(uint32_t *errors, uint32_t *packets)
+{
+#if defined(CONFIG_NET_STATISTICS_WIFI)
+    struct net_if *iface = net_if_get_default();
+    struct net_stats_wifi wst = {0};
+
+    if (iface && net_mgmt(NET_REQUEST_STATS_GET_WIFI, iface, &wst, sizeof(wst)) == 0) {
+        *errors = wst.errors.tx;
+        *packets = wst.pkts.tx;
+        return;
+    }
+#endif
+    *errors = 0;
+    *packets = 0;
+}
+
+static int current_slot(void)
+{
+    return (k_uptime_get() / SLOT_MS) % LINK_QUALITY_SLOTS;
+}
+
+static void slot_record(int slot, int rssi)
+{
+    if (!slot_seen[slot]) {
+        slot_rssi_x16[slot] = rssi * 16;
+        slot_seen[slot] = true;
+        return;
+    }
+
+    // 1/4 weight for the newest reading
+    slot_rssi_x16[slot] += (rssi * 16 - slot_rssi_x16[slot]) / 4;
+}
+
+int link_quality_slot_rssi(int slot)
+{
+    if (slot < 0 || slot >= LINK_QUALITY_SLOTS || !slot_seen[slot]) {
+        return 0;
+    }
+
+    return slot_rssi_x16[slot] / 16;
+}
+
+bool link_quality_defer_uplink(uint32_t oldest_age_ms, uint32_t next_interval_ms)
+{
+    int rssi = link_quality_rssi();
+    int slot = current_slot();
+    uint32_t budget_ms;
+    int best = INT16_MIN;
+    bool defer;
+
+    stats.rssi = rssi;
+
+    // Not associated: the connect attempt decides, not the signal
+    if (rssi == 0) {
+        return false;
+    }
+
+    if (rssi >= LINK_RSSI_DEFER_DBM) {
+        defer = false;
+    } else if ((uint64_t)oldest_age_ms + next_interval_ms > UPLINK_MAX_LATENCY_MS) {
+        stats.forced++;
+        defer = false;
+    } else {
+        // Look over the hour slots that remain before the latency bound,
+        // including this one: a dip in a usually good hour is transient.
+        // Slots without history promise nothing, so the first day sends
+        // rather than holding every weak-signal batch to the bound
+        budget_ms = UPLINK_MAX_LATENCY_MS - oldest_age_ms;
+        for (uint32_t i = 0; i <= budget_ms / SLOT_MS && i < LINK_QUALITY_SLOTS; i++) {
+            int s = (slot + i) % LINK_QUALITY_SLOTS;
+
+            if (slot_seen[s]) {
+                best = MAX(best, link_quality_slot_rssi(s));
+            }
+        }
+
+        // Only wait if history says a better signal is coming
+        defer = best >= rssi + LINK_RSSI_BETTER_DB;
+        if (defer) {
+            stats.deferred++;
+            LOG_INF("Deferring uplink at %d dBm (best ahead %d dBm)", rssi, best);
+        }
+    }
+
+    slot_record(slot, rssi);
+
+    return defer;
+}
+
+void link_quality_uplink_begin(void)
+{
+    const struct aws_mqtt_stats *mqtt = aws_mqtt_get_stats();
+
+    window_start_ms = k_uptime_get();
+    wifi_tx_counters(&window_tx_errors, &window_tx_packets);
+    window_retransmits = mqtt->retransmits;
+    window_tx_bytes = mqtt->tx_bytes;
+}
+
+void link_quality_uplink_end(void)
+{
+    const struct aws_mqtt_stats *mqtt = aws_mqtt_get_stats();
+    uint32_t airtime_ms = k_uptime_get() - window_start_ms;
+    uint32_t tx_errors;
+    uint32_t tx_packets;
+    uint32_t tx_bytes;
+
+    wifi_tx_counters(&tx_errors, &tx_packets);
+    tx_bytes = mqtt->tx_bytes - window_tx_bytes;
+
+    stats.last_retries = (tx_errors - window_tx_errors) +
+                         (mqtt->retransmits - window_retransmits);
+    stats.last_us_per_byte = tx_bytes ? (uint64_t)airtime_ms * 1000U / tx_bytes : 0;
+
+    stats.last_tx_packets = tx_packets - window_tx_packets;
+    stats.last_airtime_ms = airtime_ms;
+
+    stats.windows++;
+    stats.retries += stats.last_retries;
+    stats.tx_packets += stats.last_tx_packets;
+    stats.tx_bytes += tx_bytes;
+    stats.airtime_ms += airtime_ms;
+}
+
+const struct link_quality_stats *link_quality_get(void)
+{
+    return &stats;
+}
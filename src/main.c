@@ -24,74 +24,108 @@
 #include <zephyr/settings/settings.h>
 #include <zephyr/fs/fs.h>
 #include <zephyr/logging/log.h>
+#include <stdlib.h>
 
 #include "config.h"
+#include "app.h"
+#include "aws_mqtt.h"
+#include "data_cache.h"
+#include "diagnostics.h"
+#include "qos_policy.h"
+#include "cache_replay.h"
+#include "link_policy.h"
+#include "link_quality.h"
+#include "tx_power.h"
+#include "power_policy.h"
+#include "charge_monitor.h"
+#include "plant_data.h"
+#include "histogram.h"
+#include "ble_provisioning.h"
+#include "mqtt_commands.h"
+#include "sensor_health.h"
+#include "sensor_filter.h"
+#include "soil_forecast.h"
+#include "watering.h"
+#include "sensor_power.h"
+#include "adc_sampler.h"
+#include "aht10_driver.h"
+#include "soil_moisture_sensor.h"
+#include "max17043_driver.h"
 
 
 LOG_MODULE_REGISTER(main, CONFIG_APP_LOG_LEVEL);
 
+// Largest telemetry payload; with a small TLS profile every PUBLISH has to fit
+// in one record together with its MQTT header and topic
+#if defined(CONFIG_MBEDTLS_SSL_MAX_CONTENT_LEN)
+#define UPLINK_PAYLOAD_MAX MIN(BATCH_SIZE_MAX * PAYLOAD_RECORD_MAX + 2, \
+                               CONFIG_MBEDTLS_SSL_MAX_CONTENT_LEN - TLS_PUBLISH_OVERHEAD)
+#else
+#define UPLINK_PAYLOAD_MAX (BATCH_SIZE_MAX * PAYLOAD_RECORD_MAX + 2)
+#endif
+
+BUILD_ASSERT(UPLINK_PAYLOAD_MAX >= PAYLOAD_RECORD_MAX + 2,
+             "TLS records too small for one telemetry record");
+BUILD_ASSERT(DIAG_PAYLOAD_MAX <= UPLINK_PAYLOAD_MAX,
+             "TLS records too small for the diagnostics record");
+
 // Forward declarations
 static void button_init_handler(const struct device *dev, gpio_pin_t pin);
-void ble_provisioning_init(void);
-void aws_mqtt_init(void);
 void button_init(void);
+static void publish_work_handler(struct k_work *work);
+static void schedule_publish(uint32_t delay_ms);
 
 // Global Variables
 static const struct device *i2c_dev;
 static const struct device *button_dev;
 static const struct device *led_dev;
 static const struct device *adc_dev;
-static struct adc_sequence adc_seq = {
-    .channels = BIT(0),
-    .buffer = NULL,
-    .buffer_size = 0,
-    .resolution = ADC_RESOLUTION,
-    .oversampling = 0,
-    .calibrate = false
-};
 
-// MQTT Client
-static struct mqtt_client client;
+// Sensor reported by each ADC input
+static const enum sensor_id adc_input_sensor[ADC_INPUT_COUNT] = {
+    [ADC_INPUT_LIGHT] = SENSOR_LIGHT,
+    [ADC_INPUT_SOIL] = SENSOR_SOIL,
+    [ADC_INPUT_BATTERY] = SENSOR_BATTERY_DIVIDER,
+};
 
 // Work for publishing data
 static struct k_work_delayable publish_work;
+static uint32_t polling_interval_ms = POLLING_INTERVAL;
+static int64_t publish_due_ms;        // When publish_work is expected to start
+static atomic_t uplink_requested;     // Publish this cycle even if the batch is not full
+static bool flush_requested;          // Drain the whole offline cache on the next uplink
 
 // Connectivity Status
 bool wifi_connected = false;
 static int reconnect_attempts = 0;
 static const int MAX_RECONNECT_ATTEMPTS = 3;
 
-// Plant Data Structure
-struct plant_data {
-    char plant_id[37];        // UUID v4 string
-    char plant_name[50];
-    char plant_variety[50];
-    char plant_location[100];
-    int polling_interval;     // in minutes
-    float temperature;
-    float humidity;
-    float soil_moisture;
-    float light_level;
-    float battery_level;
-    int64_t timestamp;
-};
+// Cycle timing
+static struct app_stage_stats stage_stats[APP_STAGE_COUNT];
 
-// Function Prototypes
-static void read_sensors(struct plant_data *data);
-static void publish_data(struct plant_data *data);
-static void cache_data(struct plant_data *data);
-static void generate_and_store_uuid(void);
+static const char *const stage_names[APP_STAGE_COUNT] = {
+    [APP_STAGE_SENSORS] = "sensors",
+    [APP_STAGE_PUBLISH] = "publish",
+    [APP_STAGE_CACHE] = "cache",
+    [APP_STAGE_CYCLE] = "cycle",
+};
 
-// Settings Load Callback
-static int settings_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg)
-{
-    return 0;
-}
+// Samples collected since the last uplink
+static struct plant_sample batch[BATCH_SIZE_MAX];
+static uint8_t batch_count;
+static uint8_t batch_size = BATCH_SIZE_DEFAULT;
 
-static struct settings_handler settings_handler_data = {
-    .name = STORAGE_NAMESPACE,
-    .h_set = settings_set,
-};
+// Function Prototypes
+static void read_sensors(struct plant_sample *sample, int32_t *cell_mv);
+static void publish_batch(const struct plant_sample *samples, int count);
+static void apply_power_tier(void);
+static void release_bluetooth(void);
+static void update_link_policy(void);
+static uint32_t effective_interval_ms(void);
+static uint8_t effective_batch_size(void);
+static bool defer_uplink(bool urgent);
+static void publish_diagnostics(const char *plant_id);
+static void publish_watering_event(const char *plant_id);
 
 int main(void)
 {
@@ -106,12 +140,6 @@ int main(void)
         return ret;
     }
 
-    ret = settings_register(&settings_handler_data);
-    if (ret) {
-        LOG_ERR("Failed to register settings handler: %d", ret);
-        return ret;
-    }
-
     ret = settings_load();
     if (ret) {
         LOG_ERR("Failed to load settings: %d", ret);
@@ -119,20 +147,36 @@ int main(void)
     }
 
     // Initialize UUID
-    generate_and_store_uuid();
+    plant_meta_init();
+
+    // Count this boot and latch the reset reason
+    diagnostics_init();
 
     // Initialize I2C
-    i2c_dev = device_get_binding(I2C_DEV_NAME);
+    i2c_dev = DEVICE_DT_GET(DT_NODELABEL(i2c0));
     if (!device_is_ready(i2c_dev)) {
         LOG_ERR("I2C device not ready");
         return -ENODEV;
     }
 
+    // Probe the fuel gauge (battery readings are marked invalid if absent)
+    ret = max17043_init(i2c_dev);
+    if (ret) {
+        LOG_WRN("MAX17043 not responding: %d", ret);
+    }
+
+    // Initialize sensor power rails (all off until the first acquisition)
+    ret = sensor_power_init();
+    if (ret) {
+        LOG_ERR("Failed to initialize sensor power rails: %d", ret);
+        return ret;
+    }
+
     // Initialize GPIO for Button
     button_init();
 
     // Initialize GPIO for LED
-    led_dev = device_get_binding(LED_GPIO_PORT);
+    led_dev = DEVICE_DT_GET(DT_NODELABEL(gpio0));
     if (!device_is_ready(led_dev)) {
         LOG_ERR("LED GPIO device not ready");
         return -ENODEV;
@@ -144,24 +188,16 @@ int main(void)
         return ret;
     }
 
-    // Initialize ADC for Photoresistor
+    // Initialize ADC for Photoresistor, analog soil probe and battery divider
     adc_dev = DEVICE_DT_GET(DT_NODELABEL(adc0));
     if (!device_is_ready(adc_dev)) {
         LOG_ERR("ADC device not ready");
         return -ENODEV;
     }
 
-    struct adc_channel_cfg channel_cfg = {
-        .gain = ADC_GAIN,
-        .reference = ADC_REFERENCE,
-        .acquisition_time = ADC_ACQUISITION_TIME,
-        .channel_id = ADC_CHANNEL,
-        .differential = false
-    };
-
-    ret = adc_channel_setup(adc_dev, &channel_cfg);
+    ret = adc_sampler_init(adc_dev);
     if (ret) {
-        LOG_ERR("Failed to setup ADC channel: %d", ret);
+        LOG_ERR("Failed to setup ADC channels: %d", ret);
         return ret;
     }
 
@@ -173,210 +209,550 @@ int main(void)
     reconnect_attempts = 0;
 
     // Initialize AWS MQTT
-    aws_mqtt_init();
+    ret = aws_mqtt_init();
+    if (ret) {
+        LOG_ERR("Failed to initialize MQTT: %d", ret);
+    }
+    update_link_policy();
+
+    // Listen for on-demand commands addressed to this plant
+    ret = mqtt_commands_init(plant_meta_get()->plant_id);
+    if (ret) {
+        LOG_ERR("Failed to set up command channel: %d", ret);
+    }
+
+    // Pump for local watering, if one is fitted
+    ret = watering_init();
+    if (ret) {
+        LOG_ERR("Failed to initialize watering: %d", ret);
+    }
+
+    // Count records left in the offline cache by a previous run
+    data_cache_init();
 
     // Schedule Data Publishing
     k_work_init_delayable(&publish_work, publish_work_handler);
-    k_work_schedule(&publish_work, K_MSEC(POLLING_INTERVAL));
+    schedule_publish(effective_interval_ms());
 
     return 0;
 }
 
+// The battery tier and the soil forecast stretch the user-set interval and
+// the tier the batch size
+static uint32_t effective_interval_ms(void)
+{
+    uint32_t interval_ms = polling_interval_ms * power_policy_get()->interval_mult;
+
+    interval_ms = MIN((uint64_t)interval_ms * soil_forecast_stretch(), POLLING_INTERVAL_MAX);
+
+    // Energy is free while charging, so sample faster
+    if (charge_monitor_is_charging()) {
+        interval_ms = MAX(interval_ms / CHARGE_BOOST_INTERVAL_DIV, POLLING_INTERVAL_MIN);
+    }
+
+    // Follow the soil closely while the pump doses and the water soaks in,
+    // below the user minimum if need be
+    if (watering_active()) {
+        interval_ms = MIN(interval_ms, watering_resample_ms());
+    }
+
+    return interval_ms;
+}
+
+static uint8_t effective_batch_size(void)
+{
+    return MIN(MAX(batch_size, power_policy_get()->min_batch), BATCH_SIZE_MAX);
+}
+
+// A weak signal means retries and low PHY rates; hold the batch for a
+// better window as long as the oldest sample stays within the latency bound
+// and the batch has room for the next one
+static bool defer_uplink(bool urgent)
+{
+    uint32_t oldest_age_ms;
+
+    if (urgent || !wifi_connected || batch_count >= BATCH_SIZE_MAX) {
+        return false;
+    }
+
+    oldest_age_ms = k_uptime_get() - (int64_t)batch[0].timestamp * MSEC_PER_SEC;
+
+    return link_quality_defer_uplink(oldest_age_ms, effective_interval_ms());
+}
+
+static void update_link_policy(void)
+{
+    link_policy_update(effective_interval_ms() * effective_batch_size());
+}
+
+static void apply_power_tier(void)
+{
+    const struct power_tier_cfg *tier = power_policy_get();
+
+    ble_provisioning_set_advertising(tier->ble_advertising);
+    update_link_policy();
+}
+
+// BLE is only needed to provision. The log shows what the teardown returned
+// to the system heap; memory the controller holds elsewhere is not counted.
+static void release_bluetooth(void)
+{
+    size_t free_before = 0;
+    size_t free_after = 0;
+    size_t max_allocated;
+    int ret;
+
+    diagnostics_heap_stats(&free_before, &max_allocated);
+
+    ret = ble_provisioning_deinit();
+    if (ret) {
+        LOG_ERR("Failed to tear down Bluetooth: %d", ret);
+        return;
+    }
+
+    diagnostics_heap_stats(&free_after, &max_allocated);
+    LOG_INF("Bluetooth released, heap free %u -> %u bytes",
+            (uint32_t)free_before, (uint32_t)free_after);
+}
+
+static void stage_record(enum app_stage stage, uint32_t start_cycles)
+{
+    struct app_stage_stats *st = &stage_stats[stage];
+    uint32_t elapsed_us = k_cyc_to_us_floor32(k_cycle_get_32() - start_cycles);
+
+    st->count++;
+    st->last_us = elapsed_us;
+    st->total_us += elapsed_us;
+    st->max_us = MAX(st->max_us, elapsed_us);
+}
+
+static void schedule_publish(uint32_t delay_ms)
+{
+    publish_due_ms = k_uptime_get() + delay_ms;
+    k_work_reschedule(&publish_work, K_MSEC(delay_ms));
+}
+
 static void publish_work_handler(struct k_work *work)
 {
-    struct plant_data data = {0};
-    read_sensors(&data);
-
-    if (wifi_connected) {
-        publish_data(&data);
-        reconnect_attempts = 0;
-    } else {
-        cache_data(&data);
-        reconnect_attempts++;
-        if (reconnect_attempts < MAX_RECONNECT_ATTEMPTS) {
-            // Attempt to reconnect in the next cycle
-            wifi_connected = false;
+    uint32_t cycle_start = k_cycle_get_32();
+    uint32_t start;
+    struct plant_sample *sample = &batch[batch_count];
+    int32_t cell_mv = 0;
+    int64_t late_ms = k_uptime_get() - publish_due_ms;
+    bool on_demand = atomic_clear(&uplink_requested);
+
+    histogram_record(HIST_WORK_JITTER, late_ms > 0 ? (uint32_t)late_ms * 1000U : 0);
+
+    start = k_cycle_get_32();
+    read_sensors(sample, &cell_mv);
+    stage_record(APP_STAGE_SENSORS, start);
+    batch_count++;
+
+    // Sample sparsely while the soil is far from dry, densely near the crossing
+    if ((sample->valid & BIT(SENSOR_SOIL)) &&
+        soil_forecast_update(sample->timestamp, sample->soil_moisture,
+                             polling_interval_ms * power_policy_get()->interval_mult)) {
+        update_link_policy();
+    }
+
+    // Water locally rather than waiting on a round trip through the cloud
+    if (watering_update(sample->soil_moisture, sample->valid & BIT(SENSOR_SOIL))) {
+        update_link_policy();
+    }
+
+    // Report a finished watering event without waiting for a full batch
+    if (watering_event_pending()) {
+        on_demand = true;
+    }
+
+    if (sample->valid & BIT(SENSOR_BATTERY)) {
+        bool tier_changed = power_policy_update(sample->battery_level);
+        bool charge_changed = charge_monitor_update(cell_mv, sample->battery_level);
+
+        if (tier_changed || charge_changed) {
+            apply_power_tier();
+        }
+    }
+
+    if ((batch_count >= effective_batch_size() || on_demand) &&
+        !defer_uplink(on_demand || flush_requested)) {
+        // Wi-Fi and BLE share the radio; BLE steps back for the uplink window
+        ble_provisioning_yield(true);
+
+        if (wifi_connected) {
+            tx_power_apply();
+        }
+
+        if (wifi_connected && aws_mqtt_connect() == 0) {
+            link_quality_uplink_begin();
+            start = k_cycle_get_32();
+            publish_batch(batch, batch_count);
+            stage_record(APP_STAGE_PUBLISH, start);
+            // Airtime covers the publishes only, not the listen window or
+            // the disconnect below
+            link_quality_uplink_end();
+            reconnect_attempts = 0;
+
+            // Reaching the cloud proves provisioning is done
+            if (BLE_TEARDOWN_AFTER_UPLINK && ble_provisioning_is_enabled()) {
+                release_bluetooth();
+            }
+
+            // Reconnecting is cheaper than idling on the link for long
+            // intervals; give retained commands queued while asleep a chance
+            // to arrive first
+            if (link_policy_get()->mode == LINK_MODE_DISCONNECT) {
+                mqtt_commands_listen(COMMAND_LISTEN_WINDOW_MS);
+                aws_mqtt_disconnect();
+            } else {
+                // Messages and pings on the kept session are handled by the
+                // receive thread until the next uplink
+                aws_mqtt_release();
+            }
+
+            tx_power_update();
+        } else {
+            start = k_cycle_get_32();
+            data_cache_append(batch, batch_count);
+            stage_record(APP_STAGE_CACHE, start);
+            reconnect_attempts++;
+            if (reconnect_attempts < MAX_RECONNECT_ATTEMPTS) {
+                // Attempt to reconnect in the next cycle
+                wifi_connected = false;
+            }
         }
+
+        ble_provisioning_yield(false);
+        batch_count = 0;
     }
 
+    stage_record(APP_STAGE_CYCLE, cycle_start);
+
     // Reschedule the publish work
-    k_work_schedule(&publish_work, K_MSEC(POLLING_INTERVAL));
+    schedule_publish(effective_interval_ms());
 }
 
-static void read_sensors(struct plant_data *data)
+static void read_sensors(struct plant_sample *sample, int32_t *cell_mv)
 {
-    uint8_t raw_data[4];
-    int16_t adc_value;
+    struct adc_sampler_result adc_result;
+    uint32_t adc_inputs = 0;
+    uint32_t wanted = 0;
+    uint32_t start;
+    float level;
+    float volts;
+    float temperature;
+    float humidity;
     int ret;
 
+    memset(sample, 0, sizeof(*sample));
+
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        if (sensor_health_should_read(i)) {
+            wanted |= BIT(i);
+        }
+    }
+
+    // Switch all needed rails on together so their warm-ups overlap, then read
+    // the sensors in order of increasing warm-up time
+    sensor_power_on(wanted);
+
+    // Read battery level and cell voltage from MAX17043 (always powered); both
+    // come from the same VCELL..CONFIG burst
+    if (wanted & BIT(SENSOR_BATTERY)) {
+        start = k_cycle_get_32();
+        ret = max17043_read(i2c_dev, &level);
+        if (ret == 0) {
+            ret = max17043_read_voltage(i2c_dev, &volts);
+        }
+        sensor_health_record(SENSOR_BATTERY, ret, start);
+        if (ret) {
+            LOG_ERR("Failed to read battery level: %d", ret);
+        } else {
+            sample->battery_level = CLAMP((int32_t)level, 0, 100);
+            *cell_mv = (int32_t)(volts * 1000.0f);
+            sample->valid |= BIT(SENSOR_BATTERY);
+        }
+    }
+
     // Read temperature and humidity from AHT10
-    ret = aht10_read(i2c_dev, &data->temperature, &data->humidity);
-    if (ret) {
-        LOG_ERR("Failed to read AHT10 sensor: %d", ret);
-        data->temperature = 0.0f;
-        data->humidity = 0.0f;
+    if (wanted & BIT(SENSOR_AHT10)) {
+        sensor_power_wait(SENSOR_AHT10);
+        start = k_cycle_get_32();
+        ret = 0;
+        if (sensor_power_is_gated(SENSOR_AHT10)) {
+            // Calibration is lost whenever the rail is switched off
+            ret = aht10_init(i2c_dev);
+        }
+        if (ret == 0) {
+            ret = aht10_read(i2c_dev, &temperature, &humidity);
+        }
+        sensor_health_record(SENSOR_AHT10, ret, start);
+        if (ret) {
+            LOG_ERR("Failed to read AHT10 sensor: %d", ret);
+        } else {
+            sample->temperature = (int16_t)(temperature * 100.0f);
+            sample->humidity = (uint16_t)(humidity * 100.0f);
+            sample->valid |= BIT(SENSOR_AHT10);
+        }
     }
 
-    // Read soil moisture
-    ret = soil_moisture_read(i2c_dev, &data->soil_moisture);
-    if (ret) {
-        LOG_ERR("Failed to read soil moisture sensor: %d", ret);
-        data->soil_moisture = 0.0f;
+    // Read light level, analog soil moisture and battery divider in one ADC sequence
+    for (int i = 0; i < ADC_INPUT_COUNT; i++) {
+        if (i == ADC_INPUT_SOIL && !SOIL_PROBE_ANALOG) {
+            continue;
+        }
+        if (wanted & BIT(adc_input_sensor[i])) {
+            adc_inputs |= BIT(i);
+            sensor_power_wait(adc_input_sensor[i]);
+        }
     }
 
-    // Read light level using ADC
-    adc_seq.buffer = &adc_value;
-    adc_seq.buffer_size = sizeof(adc_value);
-    
-    ret = adc_read(adc_dev, &adc_seq);
-    if (ret == 0) {
-        data->light_level = (float)adc_value * (100.0f / ((1 << ADC_RESOLUTION) - 1));
-    } else {
-        LOG_ERR("Failed to read ADC: %d", ret);
-        data->light_level = 0.0f;
+    if (adc_inputs) {
+        start = k_cycle_get_32();
+        ret = adc_sampler_read(adc_inputs, &adc_result);
+        for (int i = 0; i < ADC_INPUT_COUNT; i++) {
+            if (adc_inputs & BIT(i)) {
+                sensor_health_record(adc_input_sensor[i],
+                                     (adc_result.valid & BIT(i)) ? 0 : ret, start);
+            }
+        }
+        if (ret) {
+            LOG_ERR("Failed to read ADC: %d", ret);
+        }
+
+        // Spikes are reported as null rather than raising false alerts
+        if ((adc_result.valid & BIT(ADC_INPUT_LIGHT)) &&
+            sensor_filter_apply(SENSOR_LIGHT, adc_result.value[ADC_INPUT_LIGHT]) == 0) {
+            sample->light_level = adc_result.value[ADC_INPUT_LIGHT];
+            sample->valid |= BIT(SENSOR_LIGHT);
+        }
+        if ((adc_result.valid & BIT(ADC_INPUT_SOIL)) &&
+            sensor_filter_apply(SENSOR_SOIL, adc_result.value[ADC_INPUT_SOIL]) == 0) {
+            sample->soil_moisture = adc_result.value[ADC_INPUT_SOIL];
+            sample->valid |= BIT(SENSOR_SOIL);
+        }
+        if (adc_result.valid & BIT(ADC_INPUT_BATTERY)) {
+            sample->battery_mv = CLAMP(adc_result.value[ADC_INPUT_BATTERY], 0, UINT16_MAX);
+            sample->valid |= BIT(SENSOR_BATTERY_DIVIDER);
+        }
     }
 
-    // Read battery level from MAX17043
-    ret = max17043_read(i2c_dev, &data->battery_level);
-    if (ret) {
-        LOG_ERR("Failed to read battery level: %d", ret);
-        data->battery_level = 0.0f;
+    // Cross-check the divider against the gauge's own cell voltage
+    if ((sample->valid & BIT(SENSOR_BATTERY)) && (sample->valid & BIT(SENSOR_BATTERY_DIVIDER))) {
+        int32_t diff_mv = sample->battery_mv - *cell_mv;
+
+        if (abs(diff_mv) > BATTERY_CROSSCHECK_MV) {
+            LOG_WRN("Battery divider and MAX17043 VCELL differ by %d mV", diff_mv);
+        }
+    }
+
+    // Read soil moisture from the I2C sensor when no analog probe is fitted
+    if (!SOIL_PROBE_ANALOG && (wanted & BIT(SENSOR_SOIL))) {
+        sensor_power_wait(SENSOR_SOIL);
+        start = k_cycle_get_32();
+        ret = soil_moisture_read(i2c_dev, &level);
+        sensor_health_record(SENSOR_SOIL, ret, start);
+        if (ret) {
+            LOG_ERR("Failed to read soil moisture sensor: %d", ret);
+        } else if (sensor_filter_apply(SENSOR_SOIL, (int32_t)(level * 100.0f)) == 0) {
+            sample->soil_moisture = (uint16_t)(level * 100.0f);
+            sample->valid |= BIT(SENSOR_SOIL);
+        }
     }
 
-    data->timestamp = k_uptime_get();
+    sensor_power_off_all();
+
+    sample->timestamp = k_uptime_get() / MSEC_PER_SEC;
 }
 
-static void generate_and_store_uuid(void)
+static void publish_batch(const struct plant_sample *samples, int count)
 {
-    uint8_t uuid[16];
-    char uuid_str[37];
-    
-    if (settings_load_subtree(STORAGE_NAMESPACE) < 0) {
-        // Generate random bytes for UUID
-        for (int i = 0; i < sizeof(uuid); i++) {
-            uuid[i] = k_cycle_get_32() & 0xFF;  // Use cycle count as entropy source
+    static char payload[UPLINK_PAYLOAD_MAX + 1];
+    char topic[128];
+    bool array = count > 1;
+    int messages = 0;
+    int sent = 0;
+    size_t len;
+    size_t sep;
+    int n;
+    int ret;
+
+    // Construct MQTT topic
+    snprintf(topic, sizeof(topic), "%s%s", MQTT_PUBLISH_TOPIC, plant_meta_get()->plant_id);
+
+    // Construct JSON payloads, a single object or arrays of batched samples,
+    // each small enough to go out in one TLS record
+    while (sent < count) {
+        len = 0;
+        if (array) {
+            payload[len++] = '[';
         }
-        
-        // Set version 4 and variant bits according to RFC 4122
-        uuid[6] = (uuid[6] & 0x0F) | 0x40;  // Version 4
-        uuid[8] = (uuid[8] & 0x3F) | 0x80;  // Variant 1
-        
-        // Format UUID string
-        snprintf(uuid_str, sizeof(uuid_str),
-                "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
-                uuid[0], uuid[1], uuid[2], uuid[3],
-                uuid[4], uuid[5], uuid[6], uuid[7],
-                uuid[8], uuid[9], uuid[10], uuid[11],
-                uuid[12], uuid[13], uuid[14], uuid[15]);
-                
-        ret = settings_save_one(KEY_UUID, uuid_str, strlen(uuid_str));
+        for (n = 0; sent + n < count; n++) {
+            sep = n > 0;
+            if (sep) {
+                payload[len] = ',';
+            }
+            ret = plant_data_format(&samples[sent + n], payload + len + sep,
+                                    MIN(sizeof(payload) - len - sep - array,
+                                        PAYLOAD_RECORD_MAX));
+            if (ret == -ENOMEM && n > 0) {
+                break;
+            }
+            if (ret < 0) {
+                LOG_ERR("Failed to format payload: %d", ret);
+                return;
+            }
+            len += sep + ret;
+        }
+        if (array) {
+            payload[len++] = ']';
+        }
+        payload[len] = '\0';
+
+        // A single live sample is superseded by the next one; batches are not
+        ret = qos_policy_publish(array ? MSG_CLASS_AGGREGATE : MSG_CLASS_TELEMETRY,
+                                 topic, (const uint8_t *)payload, len);
         if (ret) {
-            LOG_ERR("Failed to save UUID: %d", ret);
+            LOG_ERR("Failed to publish MQTT message: %d", ret);
+            data_cache_append(samples + sent, count - sent);
+            return;
+        }
+
+        sent += n;
+        messages++;
+    }
+
+    LOG_INF("Published %d sample(s) in %d message(s) to AWS IoT: %s", count, messages, topic);
+
+    publish_watering_event(plant_meta_get()->plant_id);
+
+    // Fold the low-rate diagnostics record into this wake
+    if (diagnostics_uplink_tick()) {
+        publish_diagnostics(plant_meta_get()->plant_id);
+    }
+
+    // Drain records cached while offline in the same connection window; the
+    // whole backlog goes out at once while charging
+    if (data_cache_depth() > 0) {
+        if (charge_monitor_is_charging() || flush_requested) {
+            cache_replay_run(topic, REPLAY_WINDOW_MAX, 0, NULL);
         } else {
-            LOG_INF("Generated and stored UUID: %s", uuid_str);
+            cache_replay_run(topic, REPLAY_WINDOW_DEFAULT, REPLAY_MAX_RECORDS_PER_UPLINK, NULL);
         }
-    } else {
-        LOG_INF("UUID already exists");
     }
+    flush_requested = false;
 }
 
-static void publish_data(struct plant_data *data)
+static void publish_diagnostics(const char *plant_id)
 {
     char topic[128];
-    char payload[512];
+    char payload[DIAG_PAYLOAD_MAX];
     int ret;
 
-    // Construct MQTT topic
-    snprintf(topic, sizeof(topic), "%s%s", MQTT_PUBLISH_TOPIC, data->plant_id);
-
-    // Construct JSON payload using integer arithmetic to avoid float-to-double promotion
-    snprintf(payload, sizeof(payload),
-             "{"
-             "\"plantId\":\"%s\","
-             "\"timestamp\":%lld,"
-             "\"plantName\":\"%s\","
-             "\"plantVariety\":\"%s\","
-             "\"plantLocation\":\"%s\","
-             "\"temperature\":%d.%02d,"
-             "\"humidity\":%d.%02d,"
-             "\"soilMoisture\":%d.%02d,"
-             "\"lightLevel\":%d.%02d,"
-             "\"batteryLevel\":%d.%02d"
-             "}",
-             data->plant_id,
-             data->timestamp,
-             data->plant_name,
-             data->plant_variety,
-             data->plant_location,
-             (int)data->temperature, (int)((data->temperature - (int)data->temperature) * 100),
-             (int)data->humidity, (int)((data->humidity - (int)data->humidity) * 100),
-             (int)data->soil_moisture, (int)((data->soil_moisture - (int)data->soil_moisture) * 100),
-             (int)data->light_level, (int)((data->light_level - (int)data->light_level) * 100),
-             (int)data->battery_level, (int)((data->battery_level - (int)data->battery_level) * 100));
-
-    struct mqtt_publish_param param = {
-        .message.topic.qos = MQTT_QOS_1_AT_LEAST_ONCE,
-        .message.topic.topic.utf8 = (uint8_t *)topic,
-        .message.topic.topic.size = strlen(topic),
-        .message.payload.data = payload,
-        .message.payload.len = strlen(payload),
-        .message_id = k_cycle_get_32(),
-    };
-
-    ret = mqtt_publish(&client, &param);
+    snprintf(topic, sizeof(topic), "%s%s/diag", MQTT_PUBLISH_TOPIC, plant_id);
+
+    ret = diagnostics_format(payload, sizeof(payload));
+    if (ret < 0) {
+        LOG_ERR("Failed to format diagnostics: %d", ret);
+        return;
+    }
+
+    ret = qos_policy_publish(MSG_CLASS_DIAG, topic, (const uint8_t *)payload, ret);
     if (ret) {
-        LOG_ERR("Failed to publish MQTT message: %d", ret);
-        cache_data(data);
-    } else {
-        LOG_INF("Published data to AWS IoT: %s", topic);
+        LOG_ERR("Failed to publish diagnostics: %d", ret);
     }
 }
 
-static void cache_data(struct plant_data *data)
+static void publish_watering_event(const char *plant_id)
 {
-    struct fs_file_t file;
-    char payload[512];
+    struct watering_event ev;
+    char topic[128];
+    char payload[128];
     int ret;
 
-    fs_file_t_init(&file);
-    
-    ret = fs_open(&file, CACHE_FILE_PATH, FS_O_CREATE | FS_O_WRITE | FS_O_APPEND);
-    if (ret) {
-        LOG_ERR("Failed to open cache file: %d", ret);
+    if (!watering_take_event(&ev)) {
         return;
     }
 
-    // Construct JSON payload using integer arithmetic
-    snprintf(payload, sizeof(payload),
-             "{"
-             "\"plantId\":\"%s\","
-             "\"timestamp\":%lld,"
-             "\"plantName\":\"%s\","
-             "\"plantVariety\":\"%s\","
-             "\"plantLocation\":\"%s\","
-             "\"temperature\":%d.%02d,"
-             "\"humidity\":%d.%02d,"
-             "\"soilMoisture\":%d.%02d,"
-             "\"lightLevel\":%d.%02d,"
-             "\"batteryLevel\":%d.%02d"
-             "}\n",
-             data->plant_id,
-             data->timestamp,
-             data->plant_name,
-             data->plant_variety,
-             data->plant_location,
-             (int)data->temperature, (int)((data->temperature - (int)data->temperature) * 100),
-             (int)data->humidity, (int)((data->humidity - (int)data->humidity) * 100),
-             (int)data->soil_moisture, (int)((data->soil_moisture - (int)data->soil_moisture) * 100),
-             (int)data->light_level, (int)((data->light_level - (int)data->light_level) * 100),
-             (int)data->battery_level, (int)((data->battery_level - (int)data->battery_level) * 100));
-
-    ret = fs_write(&file, payload, strlen(payload));
-    if (ret < 0) {
-        LOG_ERR("Failed to write to cache file: %d", ret);
-    } else {
-        LOG_INF("Cached data locally");
+    snprintf(topic, sizeof(topic), "%s%s/water", MQTT_PUBLISH_TOPIC, plant_id);
+
+    ret = snprintf(payload, sizeof(payload),
+                   "{\"timestamp\":%lld,\"result\":%d,\"doses\":%u,\"runtime_ms\":%u,"
+                   "\"soil_start\":%d.%02d,\"soil_end\":%d.%02d}",
+                   (int64_t)ev.timestamp * 1000, ev.result, ev.doses, ev.runtime_ms,
+                   ev.moisture_start / 100, ev.moisture_start % 100,
+                   ev.moisture_end / 100, ev.moisture_end % 100);
+    if (ret < 0 || ret >= sizeof(payload)) {
+        LOG_ERR("Failed to format watering event");
+        return;
     }
 
-    fs_close(&file);
-}
\ No newline at end of file
+    ret = qos_policy_publish(MSG_CLASS_ALERT, topic, (const uint8_t *)payload, ret);
+    if (ret) {
+        LOG_ERR("Failed to publish watering event: %d", ret);
+        watering_return_event(&ev);
+    }
+}
+
+void app_sample_now(void)
+{
+    atomic_set(&uplink_requested, 1);
+    schedule_publish(0);
+}
+
+void app_flush_cache(void)
+{
+    flush_requested = true;
+    app_sample_now();
+}
+
+int app_set_polling_interval(uint32_t interval_ms)
+{
+    if (interval_ms < POLLING_INTERVAL_MIN || interval_ms > POLLING_INTERVAL_MAX) {
+        return -EINVAL;
+    }
+
+    polling_interval_ms = interval_ms;
+    LOG_INF("Polling interval set to %u ms", interval_ms);
+    update_link_policy();
+
+    return 0;
+}
+
+uint32_t app_get_polling_interval(void)
+{
+    return polling_interval_ms;
+}
+
+int app_set_batch_size(uint8_t size)
+{
+    if (size < 1 || size > BATCH_SIZE_MAX) {
+        return -EINVAL;
+    }
+
+    batch_size = size;
+    LOG_INF("Batch size set to %u", size);
+    update_link_policy();
+
+    return 0;
+}
+
+uint8_t app_get_batch_size(void)
+{
+    return batch_size;
+}
+
+const struct app_stage_stats *app_get_stage_stats(enum app_stage stage)
+{
+    return &stage_stats[stage];
+}
+
+const char *app_stage_name(enum app_stage stage)
+{
+    return stage_names[stage];
+}
+
+uint32_t app_get_reconnect_attempts(void)
+{
+    return reconnect_attempts;
+}
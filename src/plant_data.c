@@ -0,0 +1,171 @@
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/logging/log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "plant_data.h"
+#include "power_policy.h"
+#include "sensor_health.h"
+
+LOG_MODULE_REGISTER(plant_data, LOG_LEVEL_INF);
+
+static struct plant_meta meta;
+
+static int read_string(char *dst, size_t size, size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+    int ret;
+
+    if (len > size - 1) {
+        return -EINVAL;
+    }
+
+    ret = read_cb(cb_arg, dst, len);
+    if (ret < 0) {
+        return ret;
+    }
+    dst[len] = '\0';
+
+    return 0;
+}
+
+static int meta_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+    const struct {
+        const char *key;
+        char *dst;
+        size_t size;
+    } fields[] = {
+        { KEY_UUID, meta.plant_id, sizeof(meta.plant_id) },
+        { "name", meta.plant_name, sizeof(meta.plant_name) },
+        { "variety", meta.plant_variety, sizeof(meta.plant_variety) },
+        { "location", meta.plant_location, sizeof(meta.plant_location) },
+    };
+    const char *next;
+
+    for (int i = 0; i < ARRAY_SIZE(fields); i++) {
+        if (settings_name_steq(name, fields[i].key, &next) && !next) {
+            return read_string(fields[i].dst, fields[i].size, len, read_cb, cb_arg);
+        }
+    }
+
+    return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(plant_meta, STORAGE_NAMESPACE, NULL, meta_set, NULL, NULL);
+
+void plant_meta_init(void)
+{
+    uint8_t uuid[16];
+    int ret;
+
+    if (meta.plant_id[0] != '\0') {
+        LOG_INF("UUID already exists: %s", meta.plant_id);
+        return;
+    }
+
+    // Generate random bytes for UUID
+    for (int i = 0; i < sizeof(uuid); i++) {
+        uuid[i] = k_cycle_get_32() & 0xFF;  // Use cycle count as entropy source
+    }
+
+    // Set version 4 and variant bits according to RFC 4122
+    uuid[6] = (uuid[6] & 0x0F) | 0x40;  // Version 4
+    uuid[8] = (uuid[8] & 0x3F) | 0x80;  // Variant 1
+
+    snprintf(meta.plant_id, sizeof(meta.plant_id),
+             "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+             uuid[0], uuid[1], uuid[2], uuid[3],
+             uuid[4], uuid[5], uuid[6], uuid[7],
+             uuid[8], uuid[9], uuid[10], uuid[11],
+             uuid[12], uuid[13], uuid[14], uuid[15]);
+
+    ret = settings_save_one(STORAGE_NAMESPACE "/" KEY_UUID, meta.plant_id, strlen(meta.plant_id));
+    if (ret) {
+        LOG_ERR("Failed to save UUID: %d", ret);
+    } else {
+        LOG_INF("Generated and stored UUID: %s", meta.plant_id);
+    }
+}
+
+const struct plant_meta *plant_meta_get(void)
+{
+    return &meta;
+}
+
+// Integer formatting only, no float-to-double promotion
+int plant_data_format(const struct plant_sample *sample, char *buf, size_t size)
+{
+    const struct {
+        const char *key;
+        int32_t centi;
+        enum sensor_id sensor;
+        bool critical;
+    } readings[] = {
+        { "temperature", sample->temperature, SENSOR_AHT10, true },
+        { "humidity", sample->humidity, SENSOR_AHT10, true },
+        { "soilMoisture", sample->soil_moisture, SENSOR_SOIL, true },
+        { "lightLevel", sample->light_level, SENSOR_LIGHT, false },
+        { "batteryLevel", sample->battery_level * 100, SENSOR_BATTERY, true },
+        { "batteryVoltage", sample->battery_mv / 10, SENSOR_BATTERY_DIVIDER, false },
+    };
+    bool full = power_policy_get()->full_payload;
+    int64_t timestamp_ms = (int64_t)sample->timestamp * 1000;
+    size_t len;
+    int ret;
+
+    if (full) {
+        ret = snprintf(buf, size,
+                       "{"
+                       "\"plantId\":\"%s\","
+                       "\"timestamp\":%lld,"
+                       "\"plantName\":\"%s\","
+                       "\"plantVariety\":\"%s\","
+                       "\"plantLocation\":\"%s\"",
+                       meta.plant_id,
+                       timestamp_ms,
+                       meta.plant_name,
+                       meta.plant_variety,
+                       meta.plant_location);
+    } else {
+        // Survival mode: the cloud already knows the descriptive fields
+        ret = snprintf(buf, size,
+                       "{"
+                       "\"plantId\":\"%s\","
+                       "\"timestamp\":%lld",
+                       meta.plant_id,
+                       timestamp_ms);
+    }
+    if (ret < 0 || ret >= size) {
+        return -ENOMEM;
+    }
+    len = ret;
+
+    for (int i = 0; i < ARRAY_SIZE(readings); i++) {
+        int32_t centi = readings[i].centi;
+
+        if (!full && !readings[i].critical) {
+            continue;
+        }
+        if (sample->valid & BIT(readings[i].sensor)) {
+            ret = snprintf(buf + len, size - len, ",\"%s\":%s%d.%02d",
+                           readings[i].key, centi < 0 ? "-" : "",
+                           abs(centi) / 100, abs(centi) % 100);
+        } else {
+            ret = snprintf(buf + len, size - len, ",\"%s\":null", readings[i].key);
+        }
+        if (ret < 0 || ret >= size - len) {
+            return -ENOMEM;
+        }
+        len += ret;
+    }
+
+    if (len + 1 >= size) {
+        return -ENOMEM;
+    }
+    buf[len++] = '}';
+    buf[len] = '\0';
+
+    return len;
+}
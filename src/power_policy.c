@@ -0,0 +1,62 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "config.h"
+#include "power_policy.h"
+
+LOG_MODULE_REGISTER(power_policy, LOG_LEVEL_INF);
+
+static const struct power_tier_cfg tiers[POWER_TIER_COUNT] = {
+    [POWER_TIER_NORMAL] = {
+        .min_soc = POWER_TIER_SAVER_SOC, .interval_mult = 1, .min_batch = 1,
+        .ble_advertising = true, .full_payload = true,
+    },
+    [POWER_TIER_SAVER] = {
+        .min_soc = POWER_TIER_LOW_SOC, .interval_mult = 2, .min_batch = 2,
+        .ble_advertising = true, .full_payload = true,
+    },
+    [POWER_TIER_LOW] = {
+        .min_soc = POWER_TIER_CRITICAL_SOC, .interval_mult = 4, .min_batch = 4,
+        .ble_advertising = false, .full_payload = true,
+    },
+    [POWER_TIER_CRITICAL] = {
+        .min_soc = 0, .interval_mult = 8, .min_batch = 8,
+        .ble_advertising = false, .full_payload = false,
+    },
+};
+
+static enum power_tier tier = POWER_TIER_NORMAL;
+
+bool power_policy_update(float soc)
+{
+    enum power_tier next = tier;
+
+    // Degrade as soon as SOC drops below the tier floor
+    while (next < POWER_TIER_CRITICAL && soc < tiers[next].min_soc) {
+        next++;
+    }
+
+    // Recover only once SOC is clearly above the floor of the better tier
+    while (next > POWER_TIER_NORMAL &&
+           soc >= tiers[next - 1].min_soc + POWER_TIER_HYSTERESIS) {
+        next--;
+    }
+
+    if (next == tier) {
+        return false;
+    }
+
+    LOG_INF("Power tier %d -> %d at %d%% SOC", tier, next, (int)soc);
+    tier = next;
+
+    return true;
+}
+
+enum power_tier power_policy_tier(void)
+{
+    return tier;
+}
+
+const struct power_tier_cfg *power_policy_get(void)
+{
+    return &tiers[tier];
+}
@@ -0,0 +1,45 @@
+#include <zephyr/kernel.h>
+#include <zephyr/net/mqtt.h>
+#include <zephyr/logging/log.h>
+#include "config.h"
+#include "aws_mqtt.h"
+#include "qos_policy.h"
+
+LOG_MODULE_REGISTER(qos_policy, LOG_LEVEL_INF);
+
+// Routine data is refreshed by the next uplink anyway, so only data that
+// cannot be regenerated pays for a PUBACK round trip.
+static const uint8_t class_qos[MSG_CLASS_COUNT] = {
+    [MSG_CLASS_TELEMETRY] = MQTT_QOS_0_AT_MOST_ONCE,
+    [MSG_CLASS_AGGREGATE] = MQTT_QOS_1_AT_LEAST_ONCE,
+    [MSG_CLASS_REPLAY] = MQTT_QOS_1_AT_LEAST_ONCE,
+    [MSG_CLASS_ALERT] = MQTT_QOS_1_AT_LEAST_ONCE,
+    [MSG_CLASS_DIAG] = MQTT_QOS_0_AT_MOST_ONCE,
+    [MSG_CLASS_CONTROL] = MQTT_QOS_1_AT_LEAST_ONCE,
+};
+
+static atomic_t pubacks_saved;
+
+uint8_t qos_policy_select(enum msg_class cls)
+{
+    return class_qos[cls];
+}
+
+int qos_policy_publish(enum msg_class cls, const char *topic,
+                       const uint8_t *payload, size_t len)
+{
+    uint8_t qos = qos_policy_select(cls);
+    int ret;
+
+    ret = aws_mqtt_publish(topic, payload, len, qos);
+    if (ret == 0 && qos == MQTT_QOS_0_AT_MOST_ONCE) {
+        atomic_inc(&pubacks_saved);
+    }
+
+    return ret;
+}
+
+uint32_t qos_policy_pubacks_saved(void)
+{
+    return atomic_get(&pubacks_saved);
+}
@@ -0,0 +1,115 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "sensor_filter.h"
+
+LOG_MODULE_REGISTER(sensor_filter, LOG_LEVEL_INF);
+
+struct sensor_filter {
+    int32_t history[FILTER_WINDOW];
+    uint8_t count;            // Valid entries in history
+    uint8_t next;
+    uint8_t rejects;          // Consecutive rejections at the same level
+    int32_t level;            // First reading of the current rejection run
+};
+
+// Largest step from the rolling median accepted as real, 0 to not filter
+static const int32_t spike_bound[SENSOR_COUNT] = {
+    [SENSOR_SOIL] = FILTER_SOIL_SPIKE,
+    [SENSOR_LIGHT] = FILTER_LIGHT_SPIKE,
+};
+
+static struct sensor_filter filters[SENSOR_COUNT];
+static struct sensor_filter_stats stats[SENSOR_COUNT];
+
+int32_t sensor_filter_median(int32_t *values, int count)
+{
+    // Insertion sort, a handful of compares for burst-sized inputs
+    for (int i = 1; i < count; i++) {
+        int32_t v = values[i];
+        int j = i - 1;
+
+        while (j >= 0 && values[j] > v) {
+            values[j + 1] = values[j];
+            j--;
+        }
+        values[j + 1] = v;
+    }
+
+    return values[count / 2];
+}
+
+static void push(struct sensor_filter *f, int32_t value)
+{
+    f->history[f->next] = value;
+    f->next = (f->next + 1) % FILTER_WINDOW;
+    if (f->count < FILTER_WINDOW) {
+        f->count++;
+    }
+}
+
+int sensor_filter_apply(enum sensor_id id, int32_t value)
+{
+    struct sensor_filter *f = &filters[id];
+    struct sensor_filter_stats *st = &stats[id];
+    uint32_t start = k_cycle_get_32();
+    int32_t window[FILTER_WINDOW];
+    int32_t median = 0;
+    uint32_t cycles;
+    int ret = 0;
+
+    if (spike_bound[id] == 0) {
+        return 0;
+    }
+
+    if (f->count < FILTER_WINDOW) {
+        // Not enough history to call anything a spike yet
+        push(f, value);
+    } else {
+        memcpy(window, f->history, sizeof(window));
+        median = sensor_filter_median(window, FILTER_WINDOW);
+        st->last_median = median;
+
+        // A run of rejections only counts while its readings stay within
+        // the bound of each other; scattered spikes start a new run
+        if (f->rejects && abs(value - f->level) > spike_bound[id]) {
+            f->rejects = 0;
+        }
+        if (f->rejects == 0) {
+            f->level = value;
+        }
+
+        if (abs(value - median) <= spike_bound[id]) {
+            f->rejects = 0;
+            push(f, value);
+        } else if (++f->rejects >= FILTER_MAX_REJECTS) {
+            // Persistent change, not a spike: restart the history from here
+            f->count = 0;
+            f->next = 0;
+            f->rejects = 0;
+            push(f, value);
+        } else {
+            ret = -ERANGE;
+        }
+    }
+
+    if (ret) {
+        st->rejected++;
+        LOG_DBG("Rejected %s reading %d (median %d)", sensor_health_name(id), value, median);
+    } else {
+        st->accepted++;
+    }
+
+    cycles = k_cycle_get_32() - start;
+    st->total_cycles += cycles;
+    st->max_cycles = MAX(st->max_cycles, cycles);
+
+    return ret;
+}
+
+const struct sensor_filter_stats *sensor_filter_get(enum sensor_id id)
+{
+    return &stats[id];
+}
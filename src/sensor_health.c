@@ -0,0 +1,78 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "config.h"
+#include "sensor_health.h"
+#include "histogram.h"
+
+LOG_MODULE_REGISTER(sensor_health, LOG_LEVEL_INF);
+
+static struct sensor_health health[SENSOR_COUNT];
+
+static const char *const sensor_names[SENSOR_COUNT] = {
+    [SENSOR_AHT10] = "aht10",
+    [SENSOR_SOIL] = "soil",
+    [SENSOR_LIGHT] = "light",
+    [SENSOR_BATTERY] = "battery",
+    [SENSOR_BATTERY_DIVIDER] = "vbat_adc",
+};
+
+bool sensor_health_should_read(enum sensor_id id)
+{
+    struct sensor_health *h = &health[id];
+
+    if (!h->disabled) {
+        return true;
+    }
+
+    // Disabled sensors are only touched again once their re-probe is due
+    return k_uptime_get() >= h->next_probe_ms;
+}
+
+void sensor_health_record(enum sensor_id id, int result, uint32_t start_cycles)
+{
+    struct sensor_health *h = &health[id];
+    uint32_t latency_us = k_cyc_to_us_floor32(k_cycle_get_32() - start_cycles);
+
+    histogram_record(HIST_SENSOR_READ, latency_us);
+
+    h->last_latency_us = latency_us;
+    h->total_latency_us += latency_us;
+    if (latency_us > h->max_latency_us) {
+        h->max_latency_us = latency_us;
+    }
+
+    if (result == 0) {
+        h->successes++;
+        h->consecutive_failures = 0;
+        if (h->disabled) {
+            h->disabled = false;
+            LOG_INF("Sensor %s recovered, re-enabled", sensor_names[id]);
+        }
+        return;
+    }
+
+    h->failures++;
+    if (h->consecutive_failures < UINT16_MAX) {
+        h->consecutive_failures++;
+    }
+
+    if (h->disabled) {
+        // Failed re-probe, back off until the next one
+        h->next_probe_ms = k_uptime_get() + SENSOR_REPROBE_INTERVAL_MS;
+    } else if (h->consecutive_failures >= SENSOR_MAX_CONSECUTIVE_FAILURES) {
+        h->disabled = true;
+        h->next_probe_ms = k_uptime_get() + SENSOR_REPROBE_INTERVAL_MS;
+        LOG_WRN("Sensor %s disabled after %u consecutive failures",
+                sensor_names[id], h->consecutive_failures);
+    }
+}
+
+const struct sensor_health *sensor_health_get(enum sensor_id id)
+{
+    return &health[id];
+}
+
+const char *sensor_health_name(enum sensor_id id)
+{
+    return sensor_names[id];
+}
@@ -0,0 +1,115 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "config.h"
+#include "soil_forecast.h"
+
+LOG_MODULE_REGISTER(soil_forecast, LOG_LEVEL_INF);
+
+#define SLOPE_SCALE (3600 * 256)      // Per second to per hour in Q8
+
+// Recent readings; the fit sums do not depend on their order
+static uint32_t hist_time[SOIL_FORECAST_WINDOW];
+static int32_t hist_moisture[SOIL_FORECAST_WINDOW];
+static uint8_t hist_len;
+static uint8_t hist_head;
+
+static struct soil_forecast fc = {
+    .time_to_dry_s = -1,
+    .stretch = 1,
+};
+
+// Least-squares line through the window, in integers: times are taken
+// relative to the newest reading so the intercept is the fitted moisture now
+static bool fit(uint32_t newest_s)
+{
+    int64_t n = hist_len;
+    int64_t st = 0;
+    int64_t sm = 0;
+    int64_t stt = 0;
+    int64_t stm = 0;
+    int64_t num;
+    int64_t den;
+
+    for (int i = 0; i < hist_len; i++) {
+        int64_t t = (int64_t)hist_time[i] - newest_s;
+
+        st += t;
+        sm += hist_moisture[i];
+        stt += t * t;
+        stm += t * hist_moisture[i];
+    }
+
+    num = n * stm - st * sm;
+    den = n * stt - st * st;
+    if (den == 0) {
+        return false;
+    }
+
+    fc.slope_q8 = CLAMP(num * SLOPE_SCALE / den, INT32_MIN, INT32_MAX);
+    fc.moisture = (sm - (int64_t)fc.slope_q8 * st / SLOPE_SCALE) / n;
+
+    return true;
+}
+
+bool soil_forecast_update(uint32_t timestamp_s, int32_t moisture, uint32_t base_interval_ms)
+{
+    uint8_t prev_stretch = fc.stretch;
+    int64_t ttc_s;
+    int64_t stretch;
+
+    // A jump up is a watering; the old curve no longer applies
+    if (hist_len > 0 &&
+        moisture - hist_moisture[(hist_head + SOIL_FORECAST_WINDOW - 1) % SOIL_FORECAST_WINDOW] >
+        SOIL_FORECAST_RESET_RISE) {
+        hist_len = 0;
+        hist_head = 0;
+        fc.resets++;
+    }
+
+    hist_time[hist_head] = timestamp_s;
+    hist_moisture[hist_head] = moisture;
+    hist_head = (hist_head + 1) % SOIL_FORECAST_WINDOW;
+    if (hist_len < SOIL_FORECAST_WINDOW) {
+        hist_len++;
+    }
+    fc.points = hist_len;
+
+    if (hist_len < SOIL_FORECAST_MIN_POINTS || !fit(timestamp_s)) {
+        // Too little history: sample at the normal rate
+        fc.time_to_dry_s = -1;
+        fc.stretch = 1;
+    } else if (fc.moisture <= SOIL_DRY_THRESHOLD) {
+        fc.time_to_dry_s = 0;
+        fc.stretch = 1;
+    } else if (fc.slope_q8 >= 0) {
+        // Not drying, nothing to watch for
+        fc.time_to_dry_s = -1;
+        fc.stretch = SOIL_FORECAST_MAX_STRETCH;
+    } else {
+        ttc_s = (int64_t)(SOIL_DRY_THRESHOLD - fc.moisture) * SLOPE_SCALE / fc.slope_q8;
+        fc.time_to_dry_s = MIN(ttc_s, INT32_MAX);
+
+        stretch = ttc_s * MSEC_PER_SEC /
+                  ((int64_t)SOIL_FORECAST_SAMPLES_TO_DRY * base_interval_ms);
+        fc.stretch = CLAMP(stretch, 1, SOIL_FORECAST_MAX_STRETCH);
+    }
+
+    if (fc.stretch == prev_stretch) {
+        return false;
+    }
+
+    LOG_INF("Soil %d, %d per hour (centi-percent), dry in %d s: interval x%u",
+            fc.moisture, fc.slope_q8 / 256, fc.time_to_dry_s, fc.stretch);
+
+    return true;
+}
+
+uint8_t soil_forecast_stretch(void)
+{
+    return fc.stretch;
+}
+
+const struct soil_forecast *soil_forecast_get(void)
+{
+    return &fc;
+}
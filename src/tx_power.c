@@ -0,0 +1,148 @@
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/logging/log.h>
+#if defined(CONFIG_WIFI_ESP32)
+#include <esp_wifi.h>
+#endif
+#include "config.h"
+#include "link_quality.h"
+#include "tx_power.h"
+
+LOG_MODULE_REGISTER(tx_power, LOG_LEVEL_INF);
+
+static struct tx_power_state state = {
+    .level_qdbm = TX_POWER_MAX_QDBM,
+    .floor_qdbm = TX_POWER_MIN_QDBM,
+};
+static int8_t applied_qdbm;           // 0 until the driver accepted a limit
+static uint32_t good_windows;
+
+static int txp_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+    const char *next;
+    int8_t value;
+    int ret;
+
+    if (len != sizeof(value)) {
+        return -EINVAL;
+    }
+
+    ret = read_cb(cb_arg, &value, sizeof(value));
+    if (ret < 0) {
+        return ret;
+    }
+    value = CLAMP(value, TX_POWER_MIN_QDBM, TX_POWER_MAX_QDBM);
+
+    if (settings_name_steq(name, "level", &next) && !next) {
+        state.level_qdbm = value;
+        return 0;
+    }
+    if (settings_name_steq(name, "floor", &next) && !next) {
+        state.floor_qdbm = value;
+        return 0;
+    }
+
+    return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(txp, "txp", NULL, txp_set, NULL, NULL);
+
+int tx_power_apply(void)
+{
+    if (applied_qdbm == state.level_qdbm) {
+        return 0;
+    }
+
+#if defined(CONFIG_WIFI_ESP32)
+    esp_err_t err = esp_wifi_set_max_tx_power(state.level_qdbm);
+
+    if (err != ESP_OK) {
+        LOG_ERR("Failed to set TX power %d/4 dBm: %d", state.level_qdbm, err);
+        return -EIO;
+    }
+
+    applied_qdbm = state.level_qdbm;
+
+    return 0;
+#else
+    return -ENOTSUP;
+#endif
+}
+
+static void save(void)
+{
+    int ret;
+
+    ret = settings_save_one("txp/level", &state.level_qdbm, sizeof(state.level_qdbm));
+    if (ret == 0) {
+        ret = settings_save_one("txp/floor", &state.floor_qdbm, sizeof(state.floor_qdbm));
+    }
+    if (ret) {
+        LOG_ERR("Failed to save TX power: %d", ret);
+    }
+}
+
+void tx_power_update(void)
+{
+    const struct link_quality_stats *lq = link_quality_get();
+    int rssi = link_quality_rssi();
+    int8_t level = state.level_qdbm;
+    int8_t floor = state.floor_qdbm;
+
+    if (rssi == 0) {
+        return;
+    }
+
+    // Without Wi-Fi frame counters any retry counts as a bad window
+    if (lq->last_tx_packets) {
+        state.retry_rate_pm = MIN((uint64_t)lq->last_retries * 1000U / lq->last_tx_packets,
+                                  UINT16_MAX);
+    } else {
+        state.retry_rate_pm = lq->last_retries ? 1000 : 0;
+    }
+
+    // PA energy this window saved against full power, over the share of the
+    // window actually spent transmitting
+    state.saved_uj += (uint64_t)(TX_POWER_MAX_QDBM - state.level_qdbm) * TX_POWER_UW_PER_QDBM *
+                      lq->last_airtime_ms * TX_POWER_TX_DUTY_PCT / 100U / 1000U;
+
+    if (state.retry_rate_pm > TX_POWER_RETRY_HIGH_PM || rssi < TX_POWER_RSSI_FLOOR_DBM) {
+        // Back off quickly, and remember where retries started
+        level = MIN(level + 2 * TX_POWER_STEP_QDBM, TX_POWER_MAX_QDBM);
+        if (state.retry_rate_pm > TX_POWER_RETRY_HIGH_PM) {
+            floor = MAX(floor, level);
+        }
+        good_windows = 0;
+    } else if (state.retry_rate_pm <= TX_POWER_RETRY_LOW_PM) {
+        // The channel changes over time; let a learned floor drift back down
+        if (++good_windows >= TX_POWER_FLOOR_RELAX_WINDOWS) {
+            floor = MAX(floor - TX_POWER_STEP_QDBM, TX_POWER_MIN_QDBM);
+            good_windows = 0;
+        }
+        if (rssi > TX_POWER_HEADROOM_DBM && level - TX_POWER_STEP_QDBM >= floor) {
+            level -= TX_POWER_STEP_QDBM;
+        }
+    }
+
+    if (level == state.level_qdbm && floor == state.floor_qdbm) {
+        return;
+    }
+
+    if (level < state.level_qdbm) {
+        state.steps_down++;
+    } else if (level > state.level_qdbm) {
+        state.steps_up++;
+    }
+
+    LOG_INF("TX power %d -> %d/4 dBm (floor %d/4, RSSI %d dBm, %u retries/1000)",
+            state.level_qdbm, level, floor, rssi, state.retry_rate_pm);
+
+    state.level_qdbm = level;
+    state.floor_qdbm = floor;
+    save();
+}
+
+const struct tx_power_state *tx_power_get(void)
+{
+    return &state;
+}
@@ -0,0 +1,315 @@
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+#include "config.h"
+#include "watering.h"
+
+LOG_MODULE_REGISTER(watering, LOG_LEVEL_INF);
+
+#define USER_NODE DT_PATH(zephyr_user)
+#define DAY_MS (24 * 60 * 60 * 1000LL)
+
+BUILD_ASSERT(WATER_DOSE_RESAMPLE_MS <= WATER_DOSE_MS, "No reading would fall inside a dose");
+
+enum watering_state {
+    STATE_IDLE,
+    STATE_DOSING,
+    STATE_SOAKING,
+};
+
+static const struct gpio_dt_spec pump = GPIO_DT_SPEC_GET_OR(USER_NODE, pump_gpios, {0});
+
+static enum watering_state state = STATE_IDLE;
+static struct watering_stats stats;
+static struct watering_event current;
+static struct watering_event finished;
+static bool event_pending;
+static int64_t pump_on_ms;            // Uptime the pump was switched on, 0 when off
+static uint32_t pump_run_ms;          // Length of the current run
+static int64_t soak_until_ms;
+static uint32_t day;                  // Budget day today_ms belongs to
+static int64_t day_start_ms;          // Uptime the budget day began, negative after a reboot
+static int64_t capped_day = -1;       // Day the cap was already reported
+
+/*
+ * The daily budget survives reboots, or a reset loop would grant a fresh cap
+ * every time. There is no wall clock: a budget day is 24 h of uptime, and the
+ * part of it elapsed before a reboot is carried over. Time spent powered off
+ * does not count, which only ever makes the cap stricter.
+ */
+struct water_budget {
+    uint32_t day;
+    uint32_t day_elapsed_ms;
+    uint32_t today_ms;
+};
+
+static int water_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+    struct water_budget budget;
+    const char *next;
+    int ret;
+
+    if (!settings_name_steq(name, "budget", &next) || next) {
+        return -ENOENT;
+    }
+    if (len != sizeof(budget)) {
+        return -EINVAL;
+    }
+
+    ret = read_cb(cb_arg, &budget, sizeof(budget));
+    if (ret < 0) {
+        return ret;
+    }
+
+    day = budget.day;
+    day_start_ms = -(int64_t)MIN(budget.day_elapsed_ms, DAY_MS);
+    stats.today_ms = budget.today_ms;
+
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(water, "water", NULL, water_set, NULL, NULL);
+
+static void budget_save(void)
+{
+    struct water_budget budget = {
+        .day = day,
+        .day_elapsed_ms = k_uptime_get() - day_start_ms,
+        .today_ms = stats.today_ms,
+    };
+    int ret;
+
+    ret = settings_save_one("water/budget", &budget, sizeof(budget));
+    if (ret) {
+        LOG_ERR("Failed to save watering budget: %d", ret);
+    }
+}
+
+// The timer cuts the pump even if the workqueue is stuck in an uplink; the
+// work does the bookkeeping once the queue gets to it
+static void pump_timer_expiry(struct k_timer *timer)
+{
+    gpio_pin_set_dt(&pump, 0);
+}
+
+static K_TIMER_DEFINE(pump_timer, pump_timer_expiry, NULL);
+
+static void pump_off_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(pump_off_work, pump_off_work_handler);
+
+int watering_init(void)
+{
+    int ret;
+
+    if (!WATERING_ENABLED || pump.port == NULL) {
+        return 0;
+    }
+
+    if (!gpio_is_ready_dt(&pump)) {
+        LOG_ERR("Pump GPIO not ready");
+        return -ENODEV;
+    }
+
+    ret = gpio_pin_configure_dt(&pump, GPIO_OUTPUT_INACTIVE);
+    if (ret) {
+        LOG_ERR("Failed to configure pump GPIO: %d", ret);
+        return ret;
+    }
+
+    return 0;
+}
+
+static uint32_t budget_today_ms(void)
+{
+    int64_t elapsed_ms = k_uptime_get() - day_start_ms;
+
+    if (elapsed_ms >= DAY_MS) {
+        day += elapsed_ms / DAY_MS;
+        day_start_ms += elapsed_ms / DAY_MS * DAY_MS;
+        stats.today_ms = 0;
+    }
+
+    return stats.today_ms < WATER_DAILY_CAP_MS ? WATER_DAILY_CAP_MS - stats.today_ms : 0;
+}
+
+static void pump_stop(void)
+{
+    uint32_t ran_ms;
+
+    if (!pump_on_ms) {
+        return;
+    }
+
+    k_timer_stop(&pump_timer);
+    gpio_pin_set_dt(&pump, 0);
+    ran_ms = MIN(k_uptime_get() - pump_on_ms, pump_run_ms);
+    pump_on_ms = 0;
+
+    current.runtime_ms += ran_ms;
+    stats.runtime_ms += ran_ms;
+    stats.today_ms += ran_ms;
+    budget_save();
+}
+
+// Every run is bounded by the smaller of the dose, the per-run limit and what
+// is left of the daily budget
+static bool pump_dose(void)
+{
+    uint32_t dose_ms = MIN(MIN(WATER_DOSE_MS, WATER_MAX_RUNTIME_MS), budget_today_ms());
+    int ret;
+
+    if (dose_ms == 0) {
+        return false;
+    }
+
+    ret = gpio_pin_set_dt(&pump, 1);
+    if (ret) {
+        LOG_ERR("Failed to switch pump on: %d", ret);
+        return false;
+    }
+
+    pump_on_ms = k_uptime_get();
+    pump_run_ms = dose_ms;
+    k_timer_start(&pump_timer, K_MSEC(dose_ms), K_NO_WAIT);
+    k_work_reschedule(&pump_off_work, K_MSEC(dose_ms));
+
+    current.doses++;
+    stats.doses++;
+    state = STATE_DOSING;
+
+    LOG_INF("Watering dose %u for %u ms", current.doses, dose_ms);
+
+    return true;
+}
+
+static void pump_off_work_handler(struct k_work *work)
+{
+    pump_stop();
+    soak_until_ms = k_uptime_get() + WATER_SOAK_MS;
+    state = STATE_SOAKING;
+}
+
+static void finish(int32_t moisture, enum watering_result result)
+{
+    current.moisture_end = moisture;
+    current.result = result;
+    finished = current;
+    event_pending = true;
+    stats.events++;
+    state = STATE_IDLE;
+
+    LOG_INF("Watering finished (%d): %u dose(s), %u ms, soil %d -> %d",
+            result, current.doses, current.runtime_ms,
+            current.moisture_start, current.moisture_end);
+}
+
+bool watering_update(int32_t moisture, bool valid)
+{
+    enum watering_state prev = state;
+
+    if (!WATERING_ENABLED || pump.port == NULL) {
+        return false;
+    }
+
+    // A run that outlived its off work must not continue
+    if (pump_on_ms && k_uptime_get() - pump_on_ms > WATER_MAX_RUNTIME_MS) {
+        LOG_ERR("Pump exceeded %u ms, forcing off", WATER_MAX_RUNTIME_MS);
+        k_work_cancel_delayable(&pump_off_work);
+        pump_off_work_handler(NULL);
+        stats.forced_off++;
+    }
+
+    switch (state) {
+    case STATE_IDLE:
+        if (!valid || moisture >= WATER_ON_THRESHOLD) {
+            break;
+        }
+
+        memset(&current, 0, sizeof(current));
+        current.timestamp = k_uptime_get() / MSEC_PER_SEC;
+        current.moisture_start = moisture;
+
+        if (!pump_dose() && capped_day != day) {
+            // Report the cap once a day rather than on every dry reading
+            capped_day = day;
+            finish(moisture, WATERING_CAPPED);
+        }
+        break;
+
+    case STATE_DOSING:
+        // The probe caught up mid-dose: the rest of it would overshoot
+        if (valid && moisture >= WATER_OFF_THRESHOLD) {
+            k_work_cancel_delayable(&pump_off_work);
+            pump_stop();
+            finish(moisture, WATERING_DONE);
+        }
+        break;
+
+    case STATE_SOAKING:
+        if (valid && moisture >= WATER_OFF_THRESHOLD) {
+            finish(moisture, WATERING_DONE);
+        } else if (k_uptime_get() < soak_until_ms) {
+            break;
+        } else if (!valid) {
+            // Never dose blind
+            finish(moisture, WATERING_NO_READING);
+        } else if (current.doses >= WATER_MAX_DOSES) {
+            finish(moisture, WATERING_NO_RISE);
+        } else if (!pump_dose()) {
+            finish(moisture, WATERING_CAPPED);
+        }
+        break;
+    }
+
+    return (prev == STATE_IDLE) != (state == STATE_IDLE);
+}
+
+bool watering_active(void)
+{
+    return state != STATE_IDLE;
+}
+
+uint32_t watering_resample_ms(void)
+{
+    switch (state) {
+    case STATE_DOSING:
+        return WATER_DOSE_RESAMPLE_MS;
+    case STATE_SOAKING:
+        return WATER_RESAMPLE_MS;
+    default:
+        return 0;
+    }
+}
+
+bool watering_take_event(struct watering_event *ev)
+{
+    if (!event_pending) {
+        return false;
+    }
+
+    *ev = finished;
+    event_pending = false;
+
+    return true;
+}
+
+void watering_return_event(const struct watering_event *ev)
+{
+    // A newer event supersedes one that could not be reported
+    if (!event_pending) {
+        finished = *ev;
+        event_pending = true;
+    }
+}
+
+bool watering_event_pending(void)
+{
+    return event_pending;
+}
+
+const struct watering_stats *watering_get(void)
+{
+    return &stats;
+}